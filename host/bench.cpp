@@ -0,0 +1,473 @@
+/**
+ * Measures what Gamepad::update() costs per frame, broken down by phase, across scenarios that vary the number of
+ * listeners, the number of screens and how much the input changes.
+ *
+ *   make -C host bench
+ *   host/build/gamepad_bench [--frames N] [--csv | --json]
+ *
+ * Time is simulated, advancing 10ms per frame, so every scenario sees the same button timing no matter how fast the
+ * workstation is. Allocations are counted by replacing the global operator new.
+ *
+ * The static_init row times the program's dynamic initialization up to main(), and the init row times
+ * Gamepad::init() of both gamepads, each as a single frame. The gamepads are constant-initialized, so static_init is
+ * what the host's C++ runtime and the benchmark itself cost, and would show any static constructor the library added.
+ *
+ * The baseline_fire_N and fire_N rows time a single fire() of a listener table with N listeners instead of a frame,
+ * for the std::function table the library used to have (baseline_event_handler.hpp) and the current inline one. The
+ * _big rows use listeners that capture too much for std::function to store without allocating.
+ */
+#include "baseline_event_handler.hpp"
+#include "gamepad/api.hpp"
+#include "pros_host.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<uint64_t> allocations = 0;
+gamepad::SimulatedClock simulated_clock;
+/// When dynamic initialization of the program started, and how many allocations had happened by then
+uint64_t static_init_start = 0;
+uint64_t static_init_allocations = 0;
+
+/// The time between frames in µs, the same as a typical 10ms control loop
+constexpr uint64_t FRAME_TIME = 10000;
+constexpr uint32_t WARMUP_FRAMES = 200;
+/// The kernel heap a FreeRTOS mutex takes on the V5, which is its queue struct and the heap block header
+constexpr uint32_t KERNEL_MUTEX_BYTES = 88;
+/// The kernel mutexes the library created during static init before they were created lazily. This is a fixed
+/// reference number counted from the headers of that version, which no longer exist to be measured: each gamepad had
+/// 6 listener tables on each of its 13 buttons, its own mutex, and the mutex of its default screen
+constexpr uint32_t BASELINE_KERNEL_MUTEXES = 2 * (13 * 6 + 2);
+
+const char* const PHASE_NAMES[gamepad::PHASE_COUNT] = {"sampling", "buttons", "dispatch",
+                                                       "axes",     "transform", "screens"};
+
+enum class Activity {
+    /// Nothing changes between frames
+    IDLE,
+    /// Buttons are pressed and released, and the joysticks move, every few frames
+    ACTIVE,
+    /// A is pressed on one frame and released on the next, so its listeners fire at a steady 100Hz
+    PULSE,
+};
+
+/**
+ * @brief Drives the simulated controllers with the same pseudo-random input in every run
+ */
+class InputGenerator {
+    public:
+        void step(pros::controller_id_e_t id, Activity activity) {
+            if (activity == Activity::IDLE) return;
+            if (activity == Activity::PULSE) {
+                constexpr uint32_t A = 1 << pros::E_CONTROLLER_DIGITAL_A;
+                m_held[id] ^= A;
+                pros::host::setDigital(id, pros::E_CONTROLLER_DIGITAL_A, m_held[id] & A);
+                return;
+            }
+            for (int button = pros::E_CONTROLLER_DIGITAL_L1; button <= pros::E_CONTROLLER_DIGITAL_A; button++) {
+                if (this->next() % 8 == 0) {
+                    m_held[id] ^= 1 << button;
+                    pros::host::setDigital(id, static_cast<pros::controller_digital_e_t>(button),
+                                           m_held[id] & (1 << button));
+                }
+            }
+            for (int axis = pros::E_CONTROLLER_ANALOG_LEFT_X; axis <= pros::E_CONTROLLER_ANALOG_RIGHT_Y; axis++) {
+                pros::host::setAnalog(id, static_cast<pros::controller_analog_e_t>(axis),
+                                      static_cast<int32_t>(this->next() % 255) - 127);
+            }
+        }
+    private:
+        uint32_t next() {
+            m_seed = m_seed * 1103515245 + 12345;
+            return m_seed >> 16;
+        }
+
+        uint32_t m_seed = 1;
+        uint32_t m_held[2] {};
+};
+
+/**
+ * @brief A screen that prints something new on every line every update, so the screen is always busy
+ */
+class BusyScreen : public gamepad::AbstractScreen {
+    public:
+        BusyScreen(uint32_t priority)
+            : AbstractScreen(priority) {}
+
+        void update(uint32_t delta_time) override { m_updates++; }
+
+        const gamepad::ScreenBuffer& getScreen(uint8_t visible_lines) override {
+            m_buffer.clear();
+            for (uint8_t line = 0; line < 3; line++) {
+                if (!(visible_lines & (1 << line))) continue;
+                char text[gamepad::SCREEN_WIDTH + 1];
+                std::snprintf(text, sizeof(text), "frame %u", unsigned(m_updates + line));
+                m_buffer.set(line, text);
+            }
+            return m_buffer;
+        }
+    private:
+        uint32_t m_updates = 0;
+        gamepad::ScreenBuffer m_buffer {};
+};
+
+struct Result {
+        std::string name;
+        uint32_t frames = 0;
+        double ns_per_frame = 0;
+        double p50_ns = 0;
+        double p99_ns = 0;
+        double allocs_per_frame = 0;
+        std::array<double, gamepad::PHASE_COUNT> phase_ns {};
+};
+
+struct Scenario {
+        std::string name;
+        pros::controller_id_e_t id;
+        Activity activity;
+        /// Prepares the gamepad, and returns what undoes it
+        std::function<std::function<void()>()> setup;
+};
+
+uint64_t wallTime() {
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+/**
+ * @brief Record when dynamic initialization starts, before any other constructor of the program runs
+ */
+__attribute__((constructor(101))) void startStaticInit() {
+    static_init_start = wallTime();
+    static_init_allocations = allocations.load();
+}
+
+/**
+ * @brief Time static initialization, from startStaticInit() to now, as a single frame
+ */
+Result measureStaticInit() {
+    const uint64_t end = wallTime();
+    Result result {.name = "static_init", .frames = 1};
+    result.ns_per_frame = result.p50_ns = result.p99_ns = double(end - static_init_start);
+    result.allocs_per_frame = double(allocations.load() - static_init_allocations);
+    return result;
+}
+
+/**
+ * @brief Time initializing both gamepads, which creates their default screens, as a single frame
+ */
+Result measureInit() {
+    const uint64_t allocations_before = allocations.load();
+    const uint64_t start = wallTime();
+    gamepad::master.init();
+    gamepad::partner.init();
+    const uint64_t end = wallTime();
+    Result result {.name = "init", .frames = 1};
+    result.ns_per_frame = result.p50_ns = result.p99_ns = double(end - start);
+    result.allocs_per_frame = double(allocations.load() - allocations_before);
+    return result;
+}
+
+gamepad::Gamepad& gamepadFor(pros::controller_id_e_t id) {
+    return id == pros::E_CONTROLLER_MASTER ? gamepad::master : gamepad::partner;
+}
+
+/**
+ * @brief Time the given number of updates of a gamepad
+ */
+Result measure(const std::string& name, pros::controller_id_e_t id, Activity activity, InputGenerator& input,
+               uint32_t frames) {
+    gamepad::Gamepad& gamepad = gamepadFor(id);
+    std::vector<uint64_t> times;
+    times.reserve(frames);
+    gamepad.resetProfile();
+    const uint64_t allocations_before = allocations.load();
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        input.step(id, activity);
+        simulated_clock.advance(FRAME_TIME);
+        const uint64_t start = wallTime();
+        gamepad.update();
+        times.push_back(wallTime() - start);
+        total += times.back();
+    }
+    // reserving the vector up front keeps the measurement itself from allocating
+    const uint64_t allocations_after = allocations.load();
+
+    Result result {.name = name, .frames = frames};
+    result.ns_per_frame = double(total) / frames;
+    result.allocs_per_frame = double(allocations_after - allocations_before) / frames;
+    std::sort(times.begin(), times.end());
+    result.p50_ns = times[times.size() / 2];
+    result.p99_ns = times[std::min<std::size_t>(times.size() - 1, times.size() * 99 / 100)];
+    const gamepad::UpdateProfile profile = gamepad.profile();
+    for (std::size_t phase = 0; phase < gamepad::PHASE_COUNT; phase++) {
+        if (profile.updates != 0) result.phase_ns[phase] = double(profile.ns[phase]) / profile.updates;
+    }
+    return result;
+}
+
+/**
+ * @brief Time the given number of calls to fire() of a listener table
+ */
+template <typename Handler> Result measureFire(const std::string& name, Handler& handler, uint32_t fires) {
+    std::vector<uint64_t> times;
+    times.reserve(fires);
+    const uint64_t allocations_before = allocations.load();
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < fires; i++) {
+        const uint64_t start = wallTime();
+        handler.fire();
+        times.push_back(wallTime() - start);
+        total += times.back();
+    }
+    const uint64_t allocations_after = allocations.load();
+
+    Result result {.name = name, .frames = fires};
+    result.ns_per_frame = double(total) / fires;
+    result.allocs_per_frame = double(allocations_after - allocations_before) / fires;
+    std::sort(times.begin(), times.end());
+    result.p50_ns = times[times.size() / 2];
+    result.p99_ns = times[std::min<std::size_t>(times.size() - 1, times.size() * 99 / 100)];
+    return result;
+}
+
+/**
+ * @brief Compare firing the listener table the library used to have with the current one, for the same listeners
+ *
+ * @tparam Captures how many pointers each listener captures, std::function stores up to two without allocating
+ */
+template <std::size_t Captures> void measureHandlers(std::vector<Result>& results, const std::string& suffix,
+                                                     uint32_t fires) {
+    static std::atomic<uint32_t> fired = 0;
+    for (uint32_t count : {1, 8, 64}) {
+        baseline::EventHandler<std::string> old_handler;
+        gamepad::_impl::EventHandler<std::string, 64> new_handler;
+        for (uint32_t i = 0; i < count; i++) {
+            std::array<std::atomic<uint32_t>*, Captures> counters;
+            counters.fill(&fired);
+            old_handler.addListener("listener_" + std::to_string(i), [counters] { (*counters[0])++; });
+            new_handler.addListener("listener_" + std::to_string(i), [counters] { (*counters[0])++; });
+        }
+        const std::string name = "fire_" + std::to_string(count) + suffix;
+        measureFire("baseline_" + name, old_handler, WARMUP_FRAMES);
+        results.push_back(measureFire("baseline_" + name, old_handler, fires));
+        measureFire(name, new_handler, WARMUP_FRAMES);
+        results.push_back(measureFire(name, new_handler, fires));
+    }
+}
+
+/**
+ * @brief Add the same number of listeners to the press and release of every button
+ */
+std::function<void()> addListeners(gamepad::Gamepad& gamepad, uint32_t count) {
+    static std::atomic<uint32_t> fired = 0;
+    std::vector<std::pair<const gamepad::Button*, gamepad::ListenerHandle>> handles;
+    for (int button = pros::E_CONTROLLER_DIGITAL_L1; button <= pros::E_CONTROLLER_DIGITAL_A; button++) {
+        const gamepad::Button& target = gamepad[static_cast<pros::controller_digital_e_t>(button)];
+        for (uint32_t i = 0; i < count; i++) {
+            handles.emplace_back(&target, target.addListener(gamepad::ON_PRESS, [] { fired++; }));
+            handles.emplace_back(&target, target.addListener(gamepad::ON_RELEASE, [] { fired++; }));
+        }
+    }
+    return [handles] {
+        for (auto& [button, handle] : handles) button->removeListener(handle);
+    };
+}
+
+std::vector<Scenario> scenarios() {
+    using namespace pros;
+    std::vector<Scenario> list;
+    auto nothing = [] { return std::function<void()>([] {}); };
+    list.push_back({"idle", E_CONTROLLER_MASTER, Activity::IDLE, nothing});
+    list.push_back({"active", E_CONTROLLER_MASTER, Activity::ACTIVE, nothing});
+    for (uint32_t count : {1, 8, 64}) {
+        list.push_back({"listeners_" + std::to_string(count), E_CONTROLLER_MASTER, Activity::ACTIVE,
+                        [count] { return addListeners(gamepad::master, count); }});
+    }
+    // other tasks keep adding and removing listeners on A while its listeners fire, so update() has to share the
+    // listener table with them
+    for (uint32_t threads : {1, 4, 8}) {
+        list.push_back({"contention_" + std::to_string(threads), E_CONTROLLER_MASTER, Activity::PULSE, [threads] {
+                            auto remove = addListeners(gamepad::master, 8);
+                            auto running = std::make_shared<std::atomic<bool>>(true);
+                            auto workers = std::make_shared<std::vector<std::thread>>();
+                            for (uint32_t i = 0; i < threads; i++) {
+                                workers->emplace_back([running] {
+                                    while (running->load()) {
+                                        auto handle = gamepad::master.buttonA().addListener(gamepad::ON_PRESS, [] {});
+                                        gamepad::master.buttonA().removeListener(handle);
+                                    }
+                                });
+                            }
+                            return std::function<void()>([remove, running, workers] {
+                                running->store(false);
+                                for (std::thread& worker : *workers) worker.join();
+                                remove();
+                            });
+                        }});
+    }
+    // every sequence the recognizer can hold, so the active input keeps walking the automaton
+    list.push_back({"sequences", E_CONTROLLER_MASTER, Activity::ACTIVE, [] {
+                        for (uint32_t i = 0; i < GAMEPAD_MAX_SEQUENCES; i++) {
+                            std::vector<controller_digital_e_t> buttons;
+                            for (uint32_t press = 0; press < 4; press++) {
+                                const uint32_t button = E_CONTROLLER_DIGITAL_L1 + (i + press * 5) % 12;
+                                buttons.push_back(static_cast<controller_digital_e_t>(button));
+                            }
+                            gamepad::master.onSequence("sequence_" + std::to_string(i), buttons, [] {});
+                        }
+                        return std::function<void()>([] {
+                            for (uint32_t i = 0; i < GAMEPAD_MAX_SEQUENCES; i++) {
+                                gamepad::master.removeSequence("sequence_" + std::to_string(i));
+                            }
+                        });
+                    }});
+    // screens can't be removed, so each screen scenario adds to the screens of the one before it
+    auto screens = std::make_shared<uint32_t>(0);
+    for (uint32_t count : {1, 4, 16}) {
+        list.push_back({"screens_" + std::to_string(count), E_CONTROLLER_PARTNER, Activity::ACTIVE, [count, screens] {
+                            for (; *screens < count; (*screens)++) {
+                                gamepad::partner.addScreen(std::make_shared<BusyScreen>(*screens + 1));
+                            }
+                            return std::function<void()>([] {});
+                        }});
+    }
+    // transformations can't be removed either, so they go last
+    list.push_back({"transforms", E_CONTROLLER_MASTER, Activity::ACTIVE, [] {
+                        gamepad::master.set_left_transform(
+                            gamepad::TransformationBuilder(gamepad::Deadband(0.05, 0.05)).and_then(
+                                gamepad::ExpoCurve(2, 2)));
+                        gamepad::master.set_right_transform(gamepad::TransformationBuilder(gamepad::Fisheye(5)));
+                        return std::function<void()>([] {});
+                    }});
+    return list;
+}
+
+/**
+ * @brief How many kernel mutexes the library had created at each point of the run
+ */
+struct KernelMutexes {
+        uint32_t static_init = 0;
+        uint32_t init = 0;
+};
+
+void printTable(const std::vector<Result>& results) {
+    std::printf("%-20s %8s %10s %10s %10s %8s", "scenario", "frames", "ns/frame", "p50", "p99", "allocs");
+    for (const char* phase : PHASE_NAMES) std::printf(" %10s", phase);
+    std::printf("\n");
+    for (const Result& result : results) {
+        std::printf("%-20s %8u %10.0f %10.0f %10.0f %8.3f", result.name.c_str(), result.frames, result.ns_per_frame,
+                    result.p50_ns, result.p99_ns, result.allocs_per_frame);
+        for (double ns : result.phase_ns) std::printf(" %10.0f", ns);
+        std::printf("\n");
+    }
+}
+
+void printKernelMutexes(const KernelMutexes& mutexes) {
+    std::printf("\nkernel mutexes: %u after static init (~%u bytes), %u after init() (~%u bytes)\n",
+                unsigned(mutexes.static_init), unsigned(mutexes.static_init * KERNEL_MUTEX_BYTES),
+                unsigned(mutexes.init), unsigned(mutexes.init * KERNEL_MUTEX_BYTES));
+    std::printf("reference, not measured: %u at static init before they were lazy (~%u bytes)\n",
+                unsigned(BASELINE_KERNEL_MUTEXES), unsigned(BASELINE_KERNEL_MUTEXES * KERNEL_MUTEX_BYTES));
+}
+
+void printCsv(const std::vector<Result>& results) {
+    std::printf("scenario,frames,ns_per_frame,p50_ns,p99_ns,allocs_per_frame");
+    for (const char* phase : PHASE_NAMES) std::printf(",%s_ns", phase);
+    std::printf("\n");
+    for (const Result& result : results) {
+        std::printf("%s,%u,%.1f,%.1f,%.1f,%.4f", result.name.c_str(), result.frames, result.ns_per_frame,
+                    result.p50_ns, result.p99_ns, result.allocs_per_frame);
+        for (double ns : result.phase_ns) std::printf(",%.1f", ns);
+        std::printf("\n");
+    }
+}
+
+void printJson(const std::vector<Result>& results, const KernelMutexes& mutexes) {
+    std::printf("{\"profiled\": %s, \"max_listeners\": %d, ", GAMEPAD_PROFILE ? "true" : "false",
+                GAMEPAD_MAX_LISTENERS);
+    std::printf("\"kernel_mutexes\": {\"static_init\": %u, \"init\": %u, \"baseline_reference\": %u, "
+                "\"bytes_each\": %u}, \"results\": [\n",
+                unsigned(mutexes.static_init), unsigned(mutexes.init), unsigned(BASELINE_KERNEL_MUTEXES),
+                unsigned(KERNEL_MUTEX_BYTES));
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        std::printf("  {\"scenario\": \"%s\", \"frames\": %u, \"ns_per_frame\": %.1f, \"p50_ns\": %.1f, "
+                    "\"p99_ns\": %.1f, \"allocs_per_frame\": %.4f, \"phases_ns\": {",
+                    result.name.c_str(), result.frames, result.ns_per_frame, result.p50_ns, result.p99_ns,
+                    result.allocs_per_frame);
+        for (std::size_t phase = 0; phase < gamepad::PHASE_COUNT; phase++) {
+            std::printf("%s\"%s\": %.1f", phase == 0 ? "" : ", ", PHASE_NAMES[phase], result.phase_ns[phase]);
+        }
+        std::printf("}}%s\n", i + 1 == results.size() ? "" : ",");
+    }
+    std::printf("]}\n");
+}
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete[](void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+int main(int argc, char** argv) {
+    uint32_t frames = 20000;
+    enum { TABLE, CSV, JSON } format = TABLE;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--csv") == 0) format = CSV;
+        else if (std::strcmp(argv[i], "--json") == 0) format = JSON;
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frames = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::fprintf(stderr, "usage: %s [--frames N] [--csv | --json]\n", argv[0]);
+            return 1;
+        }
+    }
+    std::vector<Result> results;
+    // the gamepads are constant-initialized, so static init does nothing for them, and init() does the rest
+    results.push_back(measureStaticInit());
+    KernelMutexes mutexes {.static_init = gamepad::kernelMutexCount()};
+    results.push_back(measureInit());
+    mutexes.init = gamepad::kernelMutexCount();
+    gamepad::setClock(&simulated_clock);
+    InputGenerator input;
+
+    // the very first update still reads the controllers and sets up the screens for the first time
+    results.push_back(measure("first_update", pros::E_CONTROLLER_MASTER, Activity::IDLE, input, 1));
+    for (const Scenario& scenario : scenarios()) {
+        std::function<void()> teardown = scenario.setup();
+        measure(scenario.name, scenario.id, scenario.activity, input, WARMUP_FRAMES);
+        results.push_back(measure(scenario.name, scenario.id, scenario.activity, input, frames));
+        teardown();
+    }
+    measureHandlers<1>(results, "", frames);
+    measureHandlers<3>(results, "_big", frames);
+
+    if (format == CSV) printCsv(results);
+    else if (format == JSON) printJson(results, mutexes);
+    else {
+        printTable(results);
+        printKernelMutexes(mutexes);
+    }
+}
@@ -0,0 +1,476 @@
+#include "pros_host.hpp"
+#include "pros/apix.h"
+#include "pros/misc.hpp"
+#include "pros/rtos.h"
+#include "pros/rtos.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pros {
+namespace {
+/// The width of a line on the screen of a V5 controller
+constexpr std::size_t LINE_WIDTH = 19;
+constexpr std::size_t LINE_COUNT = 3;
+/// The last column text can start at, as documented for controller_set_text()
+constexpr std::size_t MAX_COLUMN = 14;
+
+const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+
+struct ControllerState {
+        std::atomic<bool> digital[E_CONTROLLER_DIGITAL_A + 1] {};
+        std::atomic<int32_t> analog[E_CONTROLLER_ANALOG_RIGHT_Y + 1] {};
+        std::atomic<bool> connected = true;
+        std::atomic<uint32_t> writes = 0;
+        /// The number of writes that fail before they start to succeed again
+        std::atomic<uint32_t> failures = 0;
+        std::mutex mutex {};
+        std::string text[LINE_COUNT] {};
+        std::string rumble {};
+};
+
+ControllerState controllers[2];
+
+/// The number of mutex creations that fail before they start to succeed again
+std::atomic<uint32_t> mutex_failures = 0;
+
+/**
+ * @brief Get the state of a controller, setting errno if the id is invalid
+ */
+ControllerState* getController(controller_id_e_t id) {
+    if (id != E_CONTROLLER_MASTER && id != E_CONTROLLER_PARTNER) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return &controllers[id];
+}
+
+/**
+ * @brief Use up one of the failures set by host::failWrites(), setting errno if the write fails
+ */
+bool failWrite(ControllerState* controller) {
+    uint32_t failures = controller->failures.load();
+    while (failures != 0 && !controller->failures.compare_exchange_weak(failures, failures - 1)) {}
+    if (failures == 0) return false;
+    errno = EAGAIN;
+    return true;
+}
+
+/**
+ * @brief What a FreeRTOS task control block holds for notifications
+ */
+struct HostTask {
+        std::mutex mutex {};
+        std::condition_variable notified {};
+        uint32_t notifications = 0;
+        /// Whether the task was created by task_create(), rather than being a thread such as main()
+        bool created = false;
+        /// While the task waits on the simulated clock, when it stops waiting, and whether a notification ends the
+        /// wait early
+        uint64_t deadline = 0;
+        bool wake_on_notify = false;
+        bool woken = false;
+};
+
+/**
+ * @brief The state of the simulated clock, see host::useSimulatedTime()
+ */
+struct SimulatedTime {
+        /// Guards everything below, and the notifications of every task while the clock is simulated
+        std::mutex mutex {};
+        /// Notified whenever the clock moves, a task wakes up, or a task starts waiting
+        std::condition_variable changed {};
+        std::atomic<bool> enabled = false;
+        std::atomic<uint64_t> now = 0;
+        /// The number of created tasks that are running, rather than waiting on the simulated clock
+        uint32_t running = 0;
+        std::vector<HostTask*> waiting {};
+};
+
+SimulatedTime simulated;
+
+/**
+ * @brief What a FreeRTOS mutex is, so mutex_delete() can delete recursive mutexes too, like it does in PROS
+ */
+struct HostMutex {
+        virtual ~HostMutex() = default;
+};
+
+template <typename T> struct NativeMutex : HostMutex {
+        T native {};
+};
+
+/// The task the current thread belongs to, threads that were not created by task_create() get one the first time
+/// they need it
+thread_local HostTask* current_task = nullptr;
+
+HostTask* currentTask() {
+    // threads that were not created by task_create(), such as main(), never exit while the program needs their task
+    if (current_task == nullptr) current_task = new HostTask;
+    return current_task;
+}
+
+/**
+ * @brief Wait until every created task is waiting on the simulated clock, the lock must be held
+ */
+void waitForTasks(std::unique_lock<std::mutex>& lock) {
+    simulated.changed.wait(lock, [] { return simulated.running == 0; });
+}
+
+/**
+ * @brief Move the simulated clock forward, stopping at every deadline on the way to wake the tasks waiting for it, and
+ * letting them run until they wait again, the lock must be held
+ *
+ * @param target The time to move the clock to, in µs
+ */
+void advanceTo(std::unique_lock<std::mutex>& lock, uint64_t target) {
+    while (true) {
+        waitForTasks(lock);
+        uint64_t next = UINT64_MAX;
+        for (const HostTask* task : simulated.waiting) {
+            if (!task->woken) next = std::min(next, task->deadline);
+        }
+        if (next > target) break;
+        if (next > simulated.now) simulated.now = next;
+        for (HostTask* task : simulated.waiting) {
+            if (task->woken || task->deadline > next) continue;
+            task->woken = true;
+            if (task->created) simulated.running++;
+        }
+        simulated.changed.notify_all();
+    }
+    if (target > simulated.now) simulated.now = target;
+}
+
+/**
+ * @brief Make a task wait on the simulated clock, the lock must be held
+ *
+ * @param task The task, this must be the current task
+ * @param deadline The time to stop waiting at, in µs, or UINT64_MAX to only stop when notified
+ * @param wake_on_notify Whether a notification ends the wait early
+ */
+void waitOn(std::unique_lock<std::mutex>& lock, HostTask* task, uint64_t deadline, bool wake_on_notify) {
+    task->deadline = deadline;
+    task->wake_on_notify = wake_on_notify;
+    task->woken = false;
+    simulated.waiting.push_back(task);
+    if (task->created) simulated.running--;
+    simulated.changed.notify_all();
+    // whoever wakes the task counts it as running again
+    simulated.changed.wait(lock, [task] { return task->woken; });
+    std::erase(simulated.waiting, task);
+}
+
+/**
+ * @brief Block the current thread until the clock reaches the given time
+ *
+ * @param deadline The time in µs
+ */
+void sleepUntil(uint64_t deadline) {
+    if (!simulated.enabled.load()) {
+        const uint64_t now = c::micros();
+        if (now < deadline) std::this_thread::sleep_for(std::chrono::microseconds(deadline - now));
+        return;
+    }
+    std::unique_lock<std::mutex> lock(simulated.mutex);
+    if (deadline <= simulated.now) return;
+    HostTask* task = currentTask();
+    // a thread that is not a task, such as the one running the test, is what drives the simulated clock
+    if (!task->created) advanceTo(lock, deadline);
+    else waitOn(lock, task, deadline, false);
+}
+} // namespace
+
+namespace c {
+uint64_t micros() {
+    if (simulated.enabled.load()) return simulated.now.load();
+    auto elapsed = std::chrono::steady_clock::now() - START;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+uint32_t millis() { return micros() / 1000; }
+
+void delay(const uint32_t milliseconds) { sleepUntil(micros() + uint64_t(milliseconds) * 1000); }
+
+void task_delay(const uint32_t milliseconds) { delay(milliseconds); }
+
+void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+    *prev_time += delta;
+    sleepUntil(uint64_t(*prev_time) * 1000);
+}
+
+task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t stack_depth,
+                   const char* const name) {
+    // tasks are never deleted, so neither is their control block
+    HostTask* task = new HostTask;
+    task->created = true;
+    if (simulated.enabled.load()) {
+        std::lock_guard<std::mutex> guard(simulated.mutex);
+        simulated.running++;
+    }
+    std::thread([task, function, parameters] {
+        current_task = task;
+        function(parameters);
+        if (simulated.enabled.load()) {
+            std::lock_guard<std::mutex> guard(simulated.mutex);
+            simulated.running--;
+            simulated.changed.notify_all();
+        }
+    }).detach();
+    return task;
+}
+
+task_t task_get_current() { return currentTask(); }
+
+uint32_t task_notify(task_t task) {
+    HostTask* target = static_cast<HostTask*>(task);
+    if (simulated.enabled.load()) {
+        std::lock_guard<std::mutex> guard(simulated.mutex);
+        target->notifications++;
+        if (std::ranges::find(simulated.waiting, target) != simulated.waiting.end() && target->wake_on_notify &&
+            !target->woken) {
+            target->woken = true;
+            if (target->created) simulated.running++;
+            simulated.changed.notify_all();
+        }
+        return 1;
+    }
+    {
+        std::lock_guard<std::mutex> guard(target->mutex);
+        target->notifications++;
+    }
+    target->notified.notify_one();
+    return 1;
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+    HostTask* task = currentTask();
+    if (simulated.enabled.load()) {
+        std::unique_lock<std::mutex> lock(simulated.mutex);
+        if (task->notifications == 0 && timeout != 0) {
+            const uint64_t deadline =
+                timeout == TIMEOUT_MAX ? UINT64_MAX : simulated.now.load() + uint64_t(timeout) * 1000;
+            waitOn(lock, task, deadline, true);
+        }
+        const uint32_t notifications = task->notifications;
+        if (notifications != 0) task->notifications = clear_on_exit ? 0 : notifications - 1;
+        return notifications;
+    }
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto notified = [task] { return task->notifications != 0; };
+    if (timeout == TIMEOUT_MAX) task->notified.wait(lock, notified);
+    else task->notified.wait_for(lock, std::chrono::milliseconds(timeout), notified);
+    const uint32_t notifications = task->notifications;
+    if (notifications != 0) task->notifications = clear_on_exit ? 0 : notifications - 1;
+    return notifications;
+}
+
+mutex_t mutex_create() { return static_cast<HostMutex*>(new NativeMutex<std::timed_mutex>); }
+
+bool mutex_take(mutex_t mutex, uint32_t timeout) {
+    auto& native = static_cast<NativeMutex<std::timed_mutex>*>(static_cast<HostMutex*>(mutex))->native;
+    if (timeout == TIMEOUT_MAX) {
+        native.lock();
+        return true;
+    }
+    return native.try_lock_for(std::chrono::milliseconds(timeout));
+}
+
+bool mutex_give(mutex_t mutex) {
+    static_cast<NativeMutex<std::timed_mutex>*>(static_cast<HostMutex*>(mutex))->native.unlock();
+    return true;
+}
+
+void mutex_delete(mutex_t mutex) { delete static_cast<HostMutex*>(mutex); }
+
+mutex_t mutex_recursive_create() {
+    uint32_t failures = mutex_failures.load();
+    while (failures != 0 && !mutex_failures.compare_exchange_weak(failures, failures - 1)) {}
+    if (failures != 0) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return static_cast<HostMutex*>(new NativeMutex<std::recursive_timed_mutex>);
+}
+
+bool mutex_recursive_take(mutex_t mutex, uint32_t timeout) {
+    auto& native = static_cast<NativeMutex<std::recursive_timed_mutex>*>(static_cast<HostMutex*>(mutex))->native;
+    if (timeout == TIMEOUT_MAX) {
+        native.lock();
+        return true;
+    }
+    return native.try_lock_for(std::chrono::milliseconds(timeout));
+}
+
+bool mutex_recursive_give(mutex_t mutex) {
+    static_cast<NativeMutex<std::recursive_timed_mutex>*>(static_cast<HostMutex*>(mutex))->native.unlock();
+    return true;
+}
+
+int32_t controller_is_connected(controller_id_e_t id) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr) return PROS_ERR;
+    return controller->connected.load();
+}
+
+int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr || channel > E_CONTROLLER_ANALOG_RIGHT_Y) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return controller->connected.load() ? controller->analog[channel].load() : 0;
+}
+
+int32_t controller_get_digital(controller_id_e_t id, controller_digital_e_t button) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr || button < E_CONTROLLER_DIGITAL_L1 || button > E_CONTROLLER_DIGITAL_A) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    return controller->connected.load() && controller->digital[button].load();
+}
+
+int32_t controller_set_text(controller_id_e_t id, uint8_t line, uint8_t col, const char* str) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr || line >= LINE_COUNT || col > MAX_COLUMN) {
+        errno = EINVAL;
+        return PROS_ERR;
+    }
+    if (failWrite(controller)) return PROS_ERR;
+    std::lock_guard<std::mutex> guard(controller->mutex);
+    std::string& text = controller->text[line];
+    text.resize(LINE_WIDTH, ' ');
+    // text that runs off the right edge of the screen is cut off
+    for (std::size_t i = col; i < LINE_WIDTH && *str != '\0'; i++) text[i] = *str++;
+    controller->writes++;
+    return 1;
+}
+
+int32_t controller_clear(controller_id_e_t id) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr || failWrite(controller)) return PROS_ERR;
+    std::lock_guard<std::mutex> guard(controller->mutex);
+    for (std::string& text : controller->text) text.assign(LINE_WIDTH, ' ');
+    controller->writes++;
+    return 1;
+}
+
+int32_t controller_rumble(controller_id_e_t id, const char* rumble_pattern) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr || failWrite(controller)) return PROS_ERR;
+    std::lock_guard<std::mutex> guard(controller->mutex);
+    controller->rumble = rumble_pattern;
+    controller->writes++;
+    return 1;
+}
+} // namespace c
+
+namespace rtos {
+Mutex::Mutex()
+    : mutex(c::mutex_create(), c::mutex_delete) {}
+
+bool Mutex::take() { return c::mutex_take(mutex.get(), TIMEOUT_MAX); }
+
+bool Mutex::take(std::uint32_t timeout) { return c::mutex_take(mutex.get(), timeout); }
+
+bool Mutex::give() { return c::mutex_give(mutex.get()); }
+
+void Mutex::lock() { this->take(); }
+
+void Mutex::unlock() { this->give(); }
+
+bool Mutex::try_lock() { return this->take(0); }
+} // namespace rtos
+
+inline namespace v5 {
+Controller::Controller(controller_id_e_t id)
+    : _id(id) {}
+
+std::int32_t Controller::is_connected() { return c::controller_is_connected(_id); }
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel) { return c::controller_get_analog(_id, channel); }
+
+std::int32_t Controller::get_digital(controller_digital_e_t button) { return c::controller_get_digital(_id, button); }
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const char* str) {
+    return c::controller_set_text(_id, line, col, str);
+}
+
+std::int32_t Controller::set_text(std::uint8_t line, std::uint8_t col, const std::string& str) {
+    return c::controller_set_text(_id, line, col, str.c_str());
+}
+
+std::int32_t Controller::rumble(const char* rumble_pattern) { return c::controller_rumble(_id, rumble_pattern); }
+
+std::int32_t Controller::clear() { return c::controller_clear(_id); }
+} // namespace v5
+
+namespace host {
+void setDigital(controller_id_e_t id, controller_digital_e_t button, bool pressed) {
+    ControllerState* controller = getController(id);
+    if (controller != nullptr && button >= E_CONTROLLER_DIGITAL_L1 && button <= E_CONTROLLER_DIGITAL_A) {
+        controller->digital[button] = pressed;
+    }
+}
+
+void setAnalog(controller_id_e_t id, controller_analog_e_t axis, int32_t value) {
+    ControllerState* controller = getController(id);
+    if (controller != nullptr && axis <= E_CONTROLLER_ANALOG_RIGHT_Y) controller->analog[axis] = value;
+}
+
+void setConnected(controller_id_e_t id, bool connected) {
+    ControllerState* controller = getController(id);
+    if (controller != nullptr) controller->connected = connected;
+}
+
+std::string getText(controller_id_e_t id, uint8_t line) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr || line >= LINE_COUNT) return "";
+    std::lock_guard<std::mutex> guard(controller->mutex);
+    std::string text = controller->text[line];
+    text.resize(LINE_WIDTH, ' ');
+    return text;
+}
+
+std::string getRumble(controller_id_e_t id) {
+    ControllerState* controller = getController(id);
+    if (controller == nullptr) return "";
+    std::lock_guard<std::mutex> guard(controller->mutex);
+    return controller->rumble;
+}
+
+void failWrites(controller_id_e_t id, uint32_t count) {
+    ControllerState* controller = getController(id);
+    if (controller != nullptr) controller->failures = count;
+}
+
+void failMutexCreation(uint32_t count) { mutex_failures = count; }
+
+uint32_t getWriteCount(controller_id_e_t id) {
+    ControllerState* controller = getController(id);
+    return controller == nullptr ? 0 : controller->writes.load();
+}
+
+void useSimulatedTime(uint64_t start) {
+    std::lock_guard<std::mutex> guard(simulated.mutex);
+    simulated.now = start;
+    simulated.enabled = true;
+}
+
+void advanceTime(uint64_t micros) {
+    std::unique_lock<std::mutex> lock(simulated.mutex);
+    advanceTo(lock, simulated.now + micros);
+}
+
+void waitForTasks() {
+    std::unique_lock<std::mutex> lock(simulated.mutex);
+    pros::waitForTasks(lock);
+}
+} // namespace host
+} // namespace pros
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "pros/misc.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Controls for the host port of the PROS primitives the library uses
+ *
+ * The host port implements tasks, notifications and mutexes on top of pthreads, and keeps the state of both
+ * controllers in memory. These functions let a host program drive that state, and inspect what the library wrote to
+ * the controllers.
+ *
+ * The clock of the host port is the real time since the program started, unless useSimulatedTime() replaces it with a
+ * simulated clock. The library reads the time from the host port unless gamepad::setClock() replaces its clock.
+ */
+namespace pros::host {
+
+/**
+ * @brief Set whether or not a button of a controller is held down
+ *
+ * @param id The controller
+ * @param button The button
+ * @param pressed Whether or not the button is held down
+ */
+void setDigital(controller_id_e_t id, controller_digital_e_t button, bool pressed);
+
+/**
+ * @brief Set the value of a joystick axis of a controller
+ *
+ * @param id The controller
+ * @param axis The joystick axis
+ * @param value The value of the axis, between -127 and 127
+ */
+void setAnalog(controller_id_e_t id, controller_analog_e_t axis, int32_t value);
+
+/**
+ * @brief Set whether or not a controller is connected
+ *
+ * @param id The controller
+ * @param connected Whether or not the controller is connected
+ */
+void setConnected(controller_id_e_t id, bool connected);
+
+/**
+ * @brief Get a line of text on the screen of a controller
+ *
+ * @param id The controller
+ * @param line The line, from 0 to 2
+ * @return std::string The line, padded with spaces to the width of the screen
+ */
+std::string getText(controller_id_e_t id, uint8_t line);
+
+/**
+ * @brief Get the last rumble pattern sent to a controller
+ */
+std::string getRumble(controller_id_e_t id);
+
+/**
+ * @brief Make the next writes to a controller fail, like they do when the controller does not take a write
+ *
+ * @param id The controller
+ * @param count How many of the next times text is set, the screen is cleared, or a rumble is sent, fail with EAGAIN
+ */
+void failWrites(controller_id_e_t id, uint32_t count);
+
+/**
+ * @brief Make the next recursive mutexes fail to be created, like they do when the kernel is out of memory
+ *
+ * @param count How many of the next calls to mutex_recursive_create() return NULL
+ */
+void failMutexCreation(uint32_t count);
+
+/**
+ * @brief Get the number of times text was set, the screen was cleared, or a rumble was sent on a controller
+ */
+uint32_t getWriteCount(controller_id_e_t id);
+
+/**
+ * @brief Run the host port on a simulated clock, that only moves when it is told to
+ *
+ * While the clock is simulated, micros() and millis() read it, and delay(), task_delay_until() and the timeout of
+ * task_notify_take() wait on it, so tasks like the sampler and the dispatcher run at exactly the same times in every
+ * run. Threads that were not created by task_create(), such as main(), drive the clock: delay() on one of them moves
+ * the clock like advanceTime() does.
+ *
+ * @note call this before any task is created, there is no way back to the real clock
+ *
+ * @param start The time to start at, in µs
+ */
+void useSimulatedTime(uint64_t start);
+
+/**
+ * @brief Move the simulated clock forward
+ *
+ * The clock stops at every time a task is waiting for on the way, and each task that wakes up runs until it waits on
+ * the clock again, so this returns once every task has caught up with the new time.
+ *
+ * @note this must not be called while holding a mutex that a task is waiting for
+ *
+ * @param micros How far to move the clock, in µs
+ */
+void advanceTime(uint64_t micros);
+
+/**
+ * @brief Wait until every task is waiting on the simulated clock or for a notification, such as after notifying one
+ */
+void waitForTasks();
+} // namespace pros::host
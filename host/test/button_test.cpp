@@ -0,0 +1,219 @@
+#include "test.hpp"
+#include <cerrno>
+
+using namespace pros;
+
+namespace {
+// the times (since the button was pressed, in ms) that each event was fired at
+std::vector<uint64_t> s_presses, s_long_presses, s_repeats, s_short_releases, s_long_releases, s_double_taps,
+    s_multi_taps;
+uint64_t s_pressed_at = 0;
+
+void listen(test::Sim& sim, const gamepad::Button& button) {
+    auto at = [&sim](std::vector<uint64_t>& times) {
+        return [&sim, &times] { times.push_back((sim.now() - s_pressed_at) / 1000); };
+    };
+    button.onPress("press", at(s_presses));
+    button.onLongPress("longPress", at(s_long_presses));
+    button.onRepeatPress("repeat", at(s_repeats));
+    button.onShortRelease("shortRelease", at(s_short_releases));
+    button.onLongRelease("longRelease", at(s_long_releases));
+}
+} // namespace
+
+TEST(button_short_press) {
+    test::Sim sim;
+    listen(sim, sim.gamepad().buttonA());
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    s_pressed_at = sim.now() + test::Sim::FRAME * 1000;
+    sim.step();
+    CHECK(sim.gamepad().buttonA().rising_edge);
+    sim.run(200);
+    sim.release(E_CONTROLLER_DIGITAL_A);
+    sim.step();
+    CHECK(sim.gamepad().buttonA().falling_edge);
+    CHECK_EQ(s_presses.size(), 1u);
+    CHECK_EQ(s_presses[0], 0u);
+    CHECK(s_long_presses.empty());
+    CHECK(s_repeats.empty());
+    CHECK_EQ(s_short_releases.size(), 1u);
+    CHECK(s_long_releases.empty());
+}
+
+TEST(button_long_press_and_repeat) {
+    test::Sim sim;
+    const gamepad::Button& button = sim.gamepad().buttonA();
+    listen(sim, button);
+    button.setLongPressThreshold(300);
+    button.setRepeatCooldown(100);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    s_pressed_at = sim.now() + test::Sim::FRAME * 1000;
+    sim.step();
+    sim.run(1000);
+    CHECK_EQ(button.time_held, 1000u);
+    sim.release(E_CONTROLLER_DIGITAL_A);
+    sim.step();
+
+    CHECK_EQ(s_long_presses.size(), 1u);
+    CHECK_EQ(s_long_presses[0], 300u);
+    // the first repeat comes the update after the long press, then one every cooldown
+    CHECK_EQ(s_repeats.size(), 7u);
+    for (std::size_t i = 0; i < s_repeats.size(); i++) CHECK_EQ(s_repeats[i], 310 + i * 100);
+    CHECK_EQ(button.repeat_iterations, 7u);
+    CHECK(s_short_releases.empty());
+    CHECK_EQ(s_long_releases.size(), 1u);
+}
+
+TEST(button_double_and_multi_tap) {
+    test::Sim sim;
+    const gamepad::Button& button = sim.gamepad().buttonB();
+    button.onDoubleTap("double", [] { s_double_taps.push_back(0); });
+    button.onMultiTap("multi", [&] { s_multi_taps.push_back(button.tap_count); });
+    sim.step();
+    for (int i = 0; i < 3; i++) {
+        sim.press(E_CONTROLLER_DIGITAL_B);
+        sim.run(50);
+        sim.release(E_CONTROLLER_DIGITAL_B);
+        sim.run(100);
+    }
+    CHECK_EQ(s_double_taps.size(), 1u);
+    // the series only ends once the tap window has passed since the last tap
+    CHECK(s_multi_taps.empty());
+    sim.run(200);
+    CHECK_EQ(s_multi_taps.size(), 1u);
+    CHECK_EQ(s_multi_taps[0], 3u);
+
+    // a press outside the window starts a new series
+    sim.press(E_CONTROLLER_DIGITAL_B);
+    sim.step();
+    CHECK_EQ(button.tap_count, 1u);
+}
+
+TEST(button_delay_press_for_taps) {
+    test::Sim sim;
+    const gamepad::Button& button = sim.gamepad().buttonB();
+    button.setDelayPressForTaps(true);
+    button.onPress("press", [] { s_presses.push_back(0); });
+    button.onDoubleTap("double", [] { s_double_taps.push_back(0); });
+    sim.step();
+
+    // a single tap fires its press once the tap window has passed
+    sim.press(E_CONTROLLER_DIGITAL_B);
+    sim.run(50);
+    sim.release(E_CONTROLLER_DIGITAL_B);
+    sim.run(100);
+    CHECK(s_presses.empty());
+    sim.run(200);
+    CHECK_EQ(s_presses.size(), 1u);
+
+    // a double tap never fires the press
+    for (int i = 0; i < 2; i++) {
+        sim.press(E_CONTROLLER_DIGITAL_B);
+        sim.run(50);
+        sim.release(E_CONTROLLER_DIGITAL_B);
+        sim.run(50);
+    }
+    sim.run(300);
+    CHECK_EQ(s_presses.size(), 1u);
+    CHECK_EQ(s_double_taps.size(), 1u);
+}
+
+TEST(button_remove_listener) {
+    test::Sim sim;
+    int presses = 0;
+    const gamepad::Button& button = sim.gamepad().buttonX();
+    CHECK_EQ(button.onPress("press", [&] { presses++; }), 0);
+    CHECK_EQ(button.onPress("press", [&] { presses++; }), INT32_MAX);
+    gamepad::ListenerHandle handle = button.addListener(gamepad::ON_PRESS, [&] { presses += 10; });
+    CHECK(handle.isValid());
+    sim.press(E_CONTROLLER_DIGITAL_X);
+    sim.step();
+    CHECK_EQ(presses, 11);
+
+    CHECK_EQ(button.removeListener(gamepad::ON_PRESS, "press"), 0);
+    CHECK_EQ(button.removeListener(handle), 0);
+    CHECK_EQ(button.removeListener(handle), INT32_MAX);
+    sim.release(E_CONTROLLER_DIGITAL_X);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_X);
+    sim.step();
+    CHECK_EQ(presses, 11);
+}
+
+TEST(button_foreign_handle) {
+    test::Sim sim;
+    int a = 0, b = 0;
+    const gamepad::Button& button_a = sim.gamepad().buttonA();
+    const gamepad::Button& button_b = sim.gamepad().buttonB();
+    // both listeners are the first of their handler, so they have the same slot, generation and event
+    gamepad::ListenerHandle handle_a = button_a.addListener(gamepad::ON_PRESS, [&] { a++; });
+    gamepad::ListenerHandle handle_b = button_b.addListener(gamepad::ON_PRESS, [&] { b++; });
+    CHECK(handle_a != handle_b);
+    CHECK_EQ(button_b.removeListener(handle_a), INT32_MAX);
+    CHECK_EQ(gamepad::partner.buttonA().removeListener(handle_a), INT32_MAX);
+
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    sim.press(E_CONTROLLER_DIGITAL_B);
+    sim.step();
+    CHECK_EQ(a, 1);
+    CHECK_EQ(b, 1);
+    CHECK_EQ(button_a.removeListener(handle_a), 0);
+    CHECK_EQ(button_b.removeListener(handle_b), 0);
+}
+
+TEST(button_interest) {
+    test::Sim sim;
+    int long_presses = 0;
+    const gamepad::Button& button = sim.gamepad().buttonY();
+    button.setLongPressThreshold(300);
+    button.setRepeatCooldown(100);
+    auto hold = [&] {
+        sim.press(E_CONTROLLER_DIGITAL_Y);
+        sim.run(1000);
+        sim.release(E_CONTROLLER_DIGITAL_Y);
+        sim.step();
+    };
+    sim.step();
+
+    // without listeners, the hold is not tracked, so only the press and the release events come up to be skipped
+    hold();
+    CHECK_EQ(button.repeat_iterations, 0u);
+    CHECK_EQ(sim.gamepad().skippedEvents(), 3u);
+
+    // a long press listener turns the tracking back on, and the repeats nobody listens to are skipped
+    gamepad::ListenerHandle handle = button.addListener(gamepad::ON_LONG_PRESS, [&] { long_presses++; });
+    CHECK(handle.isValid());
+    hold();
+    CHECK_EQ(long_presses, 1);
+    CHECK_EQ(button.repeat_iterations, 7u);
+    CHECK_EQ(sim.gamepad().skippedEvents(), 3u + 3 + 7);
+
+    // removing the last listener turns it off again, so the long press is not even raised
+    CHECK_EQ(button.removeListener(handle), 0);
+    hold();
+    CHECK_EQ(long_presses, 1);
+    CHECK_EQ(button.repeat_iterations, 7u);
+    CHECK_EQ(sim.gamepad().skippedEvents(), 3u + 3 + 7 + 3);
+}
+
+TEST(button_listener_limit) {
+    test::Sim sim;
+    const gamepad::Button& button = sim.gamepad().buttonUp();
+    for (int i = 0; i < GAMEPAD_MAX_LISTENERS; i++) CHECK_EQ(button.onPress("press" + std::to_string(i), [] {}), 0);
+    errno = 0;
+    CHECK_EQ(button.onPress("press0", [] {}), INT32_MAX);
+    CHECK_EQ(errno, EEXIST);
+    errno = 0;
+    CHECK_EQ(button.onPress("one too many", [] {}), INT32_MAX);
+    CHECK_EQ(errno, ENOMEM);
+    errno = 0;
+    CHECK(!button.addListener(gamepad::ON_PRESS, [] {}).isValid());
+    CHECK_EQ(errno, ENOMEM);
+
+    // the limit is per event
+    CHECK_EQ(button.onRelease("release", [] {}), 0);
+    CHECK_EQ(button.removeListener(gamepad::ON_PRESS, "press0"), 0);
+    CHECK_EQ(button.onPress("one too many", [] {}), 0);
+}
@@ -0,0 +1,167 @@
+#include "test.hpp"
+#include <bit>
+
+using namespace pros;
+
+TEST(chord_fires_once_per_press) {
+    test::Sim sim;
+    int chords = 0;
+    CHECK_EQ(sim.gamepad().onChord("chord", {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1}, [&] { chords++; }),
+             0);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.run(500);
+    CHECK_EQ(chords, 1);
+
+    // pressing one button again on its own is outside the window of the other
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    CHECK_EQ(chords, 1);
+
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.release(E_CONTROLLER_DIGITAL_R1);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.step();
+    CHECK_EQ(chords, 2);
+}
+
+TEST(chord_window) {
+    test::Sim sim;
+    int chords = 0;
+    sim.gamepad().onChord("chord", {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1}, [&] { chords++; }, 100);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.run(150);
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.step();
+    CHECK_EQ(chords, 0);
+}
+
+TEST(chord_suppression) {
+    test::Sim sim;
+    int chords = 0, l1 = 0, r1 = 0, releases = 0;
+    sim.gamepad().onChord("chord", {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1}, [&] { chords++; }, 100, true);
+    sim.gamepad().buttonL1().onPress("l1", [&] { l1++; });
+    sim.gamepad().buttonR1().onPress("r1", [&] { r1++; });
+    sim.gamepad().buttonL1().onRelease("release", [&] { releases++; });
+    sim.step();
+
+    // the chord claims the presses of its buttons
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.run(50);
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.run(300);
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.release(E_CONTROLLER_DIGITAL_R1);
+    sim.run(100);
+    CHECK_EQ(chords, 1);
+    CHECK_EQ(l1, 0);
+    CHECK_EQ(r1, 0);
+    CHECK_EQ(releases, 0);
+
+    // pressing one button on its own still fires its press, once the window has passed
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.run(50);
+    CHECK_EQ(l1, 0);
+    sim.run(100);
+    CHECK_EQ(l1, 1);
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    CHECK_EQ(releases, 1);
+    CHECK_EQ(chords, 1);
+}
+
+TEST(chord_invalid) {
+    test::Sim sim;
+    errno = 0;
+    CHECK_EQ(sim.gamepad().onChord("chord", {E_CONTROLLER_DIGITAL_L1}, [] {}), INT32_MAX);
+    CHECK_EQ(errno, EINVAL);
+    CHECK_EQ(sim.gamepad().removeChord("chord", {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1}), INT32_MAX);
+}
+
+TEST(chord_remove) {
+    test::Sim sim;
+    int chords = 0, l1 = 0;
+    const std::vector<controller_digital_e_t> buttons = {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1};
+    sim.gamepad().onChord("first", buttons, [&] { chords++; }, 200, true);
+    sim.gamepad().onChord("second", buttons, [&] { chords++; }, 200, true);
+    sim.gamepad().buttonL1().onPress("l1", [&] { l1++; });
+    sim.step();
+
+    // one listener is left, so presses are still held back for the chord
+    CHECK_EQ(sim.gamepad().removeChord("first", buttons), 0);
+    CHECK_EQ(sim.gamepad().removeChord("first", buttons), INT32_MAX);
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    CHECK_EQ(l1, 0);
+    sim.run(200);
+    CHECK_EQ(l1, 1);
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+
+    // removing the last listener removes the chord, so presses are no longer held back
+    CHECK_EQ(sim.gamepad().removeChord("second", buttons), 0);
+    CHECK_EQ(sim.gamepad().removeChord("second", buttons), INT32_MAX);
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    CHECK_EQ(l1, 2);
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.step();
+    CHECK_EQ(chords, 0);
+}
+
+TEST(chord_failed_add_keeps_options) {
+    test::Sim sim;
+    int chords = 0, l1 = 0;
+    const std::vector<controller_digital_e_t> buttons = {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1};
+    CHECK_EQ(sim.gamepad().onChord("chord", buttons, [&] { chords++; }, 100, true), 0);
+    errno = 0;
+    CHECK_EQ(sim.gamepad().onChord("chord", buttons, [&] { chords++; }, 500, false), INT32_MAX);
+    CHECK_EQ(errno, EEXIST);
+    sim.gamepad().buttonL1().onPress("l1", [&] { l1++; });
+    sim.step();
+
+    // the press is still held back, for the window of the listener that was added
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    CHECK_EQ(l1, 0);
+    sim.run(100);
+    CHECK_EQ(l1, 1);
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.step();
+    CHECK_EQ(chords, 0);
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.release(E_CONTROLLER_DIGITAL_R1);
+    sim.step();
+
+    // and the chord still claims the presses of its buttons
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.run(200);
+    CHECK_EQ(chords, 1);
+    CHECK_EQ(l1, 1);
+}
+
+TEST(chord_many_in_one_update) {
+    test::Sim sim;
+    int chords = 0;
+    // every combination of 2 or more of 6 buttons is a chord, which is 57 chords completed by one press
+    for (uint16_t mask = 0; mask < 1 << 6; mask++) {
+        if (std::popcount(mask) < 2) continue;
+        std::vector<controller_digital_e_t> buttons;
+        for (int i = 0; i < 6; i++) {
+            if (mask & (1 << i)) buttons.push_back(static_cast<controller_digital_e_t>(E_CONTROLLER_DIGITAL_L1 + i));
+        }
+        CHECK_EQ(sim.gamepad().onChord("chord", buttons, [&] { chords++; }), 0);
+    }
+    sim.step();
+    for (int i = 0; i < 6; i++) sim.press(static_cast<controller_digital_e_t>(E_CONTROLLER_DIGITAL_L1 + i));
+    sim.step();
+    CHECK_EQ(chords, 57);
+}
@@ -0,0 +1,117 @@
+#include "test.hpp"
+#include <algorithm>
+#include <memory>
+
+using namespace pros;
+
+namespace {
+/**
+ * @brief A screen that always shows the same line, so the end of an alert above it is written to the controller
+ */
+class IdleScreen : public gamepad::AbstractScreen {
+    public:
+        IdleScreen()
+            : AbstractScreen(1) {
+            m_buffer.set(0, "idle");
+        }
+
+        const gamepad::ScreenBuffer& getScreen(uint8_t visible_lines) override {
+            return visible_lines & 1 ? m_buffer : EMPTY_BUFFER;
+        }
+    private:
+        gamepad::ScreenBuffer m_buffer {};
+};
+} // namespace
+
+TEST(clock_hours_of_long_presses) {
+    test::Sim sim;
+    const gamepad::Button& button = sim.gamepad().buttonA();
+    uint64_t pressed_at = 0;
+    uint32_t long_presses = 0, repeats = 0, long_releases = 0;
+    uint64_t worst_long_press = 0, worst_repeat = 0;
+    uint64_t last_repeat = 0;
+    button.onLongPress("longPress", [&] {
+        long_presses++;
+        worst_long_press = std::max(worst_long_press, sim.now() - pressed_at - 500000);
+        last_repeat = sim.now();
+    });
+    button.onRepeatPress("repeat", [&] {
+        repeats++;
+        // the first repeat comes the update after the long press
+        const uint64_t expected = repeats == 1 ? test::Sim::FRAME * 1000 : 50000;
+        worst_repeat = std::max(worst_repeat, sim.now() - last_repeat - expected);
+        last_repeat = sim.now();
+    });
+    button.onLongRelease("longRelease", [&] {
+        long_releases++;
+        repeats = 0;
+    });
+
+    // two hours of holding A for 2 seconds out of every 10
+    constexpr uint32_t CYCLES = 2 * 60 * 60 / 10;
+    uint32_t total_repeats = 0;
+    sim.step();
+    for (uint32_t i = 0; i < CYCLES; i++) {
+        sim.press(E_CONTROLLER_DIGITAL_A);
+        pressed_at = sim.now() + test::Sim::FRAME * 1000;
+        sim.run(2000);
+        sim.release(E_CONTROLLER_DIGITAL_A);
+        total_repeats += repeats;
+        sim.run(8000);
+    }
+    CHECK_EQ(long_presses, CYCLES);
+    CHECK_EQ(long_releases, CYCLES);
+    // repeats at 510, 560, ... 1960ms into each hold
+    CHECK_EQ(total_repeats, CYCLES * 30);
+    CHECK_EQ(worst_long_press, 0u);
+    CHECK_EQ(worst_repeat, 0u);
+    CHECK_EQ(button.time_released, 7990u);
+}
+
+TEST(clock_hour_long_hold) {
+    test::Sim sim;
+    const gamepad::Button& button = sim.gamepad().buttonB();
+    uint32_t repeats = 0;
+    button.onRepeatPress("repeat", [&] { repeats++; });
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_B);
+    sim.step();
+    sim.run(60 * 60 * 1000);
+    CHECK_EQ(button.time_held, 60u * 60 * 1000);
+    CHECK_EQ(button.repeat_iterations, repeats);
+    CHECK_EQ(repeats, (60u * 60 * 1000 - 510) / 50 + 1);
+}
+
+TEST(clock_hours_of_alerts) {
+    test::Sim sim;
+    auto alerts = std::make_shared<gamepad::AlertScreen>();
+    sim.gamepad().addScreen(alerts);
+    sim.gamepad().addScreen(std::make_shared<IdleScreen>());
+
+    // two hours of a 3 second alert every 10 seconds, timing how long each one is on the screen
+    constexpr uint32_t CYCLES = 2 * 60 * 60 / 10;
+    uint32_t shown = 0;
+    uint64_t shown_at = 0;
+    std::vector<uint64_t> durations;
+    for (uint32_t i = 0; i < CYCLES; i++) {
+        alerts->addAlerts(0, "alert " + std::to_string(i), 3000);
+        for (uint32_t elapsed = 0; elapsed < 10000; elapsed += test::Sim::FRAME) {
+            sim.step();
+            const bool alert = pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("alert");
+            if (alert && shown_at == 0) {
+                shown++;
+                shown_at = sim.now();
+            } else if (!alert && shown_at != 0) {
+                durations.push_back(sim.now() - shown_at);
+                shown_at = 0;
+            }
+        }
+    }
+    CHECK_EQ(shown, CYCLES);
+    CHECK_EQ(durations.size(), std::size_t(CYCLES));
+    // the alert is timed from when it is picked, and both writes wait for a free write slot
+    for (uint64_t duration : durations) {
+        CHECK(duration + 2 * gamepad::_impl::LineScheduler::WRITE_INTERVAL * 1000 >= 3000000);
+        CHECK(duration <= 3000000 + 2 * gamepad::_impl::LineScheduler::WRITE_INTERVAL * 1000);
+    }
+}
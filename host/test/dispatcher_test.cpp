@@ -0,0 +1,64 @@
+#include "test.hpp"
+#include "pros/rtos.h"
+#include <cerrno>
+
+using namespace pros;
+
+namespace {
+std::vector<int> s_order;
+std::vector<task_t> s_tasks;
+
+controller_digital_e_t buttonAt(int index) {
+    return static_cast<controller_digital_e_t>(E_CONTROLLER_DIGITAL_L1 + index);
+}
+} // namespace
+
+TEST(dispatcher_queue) {
+    test::Sim sim;
+    gamepad::Gamepad& gamepad = sim.gamepad();
+    for (int i = 0; i < 12; i++) {
+        gamepad[buttonAt(i)].onPress("record", [i] {
+            s_order.push_back(i);
+            s_tasks.push_back(c::task_get_current());
+            // the first press holds up the dispatcher for a second, so the presses after it pile up in the queue
+            if (i == 0) c::delay(1000);
+        });
+    }
+    CHECK_EQ(gamepad.startDispatcher(), 0);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    const uint64_t blocked_at = sim.now();
+    CHECK_EQ(s_order.size(), 1u);
+
+    // press and release every other button 8 times, which is 88 presses for a queue of 64
+    uint64_t first_queued = 0;
+    for (int cycle = 0; cycle < 8; cycle++) {
+        for (int i = 1; i < 12; i++) sim.press(buttonAt(i));
+        sim.step();
+        if (cycle == 0) first_queued = sim.now();
+        for (int i = 1; i < 12; i++) sim.release(buttonAt(i));
+        sim.step();
+    }
+    CHECK_EQ(s_order.size(), 1u);
+    CHECK_EQ(gamepad.maxQueuedEvents(), GAMEPAD_EVENT_QUEUE_SIZE);
+    CHECK_EQ(gamepad.droppedEvents(), 8 * 11 - GAMEPAD_EVENT_QUEUE_SIZE);
+
+    // once the dispatcher is free, it runs the presses that fit in the queue, in the order they happened
+    sim.run(1000);
+    CHECK_EQ(s_order.size(), 1u + GAMEPAD_EVENT_QUEUE_SIZE);
+    for (int i = 0; i < GAMEPAD_EVENT_QUEUE_SIZE; i++) CHECK_EQ(s_order[1 + i], 1 + i % 11);
+    CHECK(s_tasks[0] != c::task_get_current());
+    for (task_t task : s_tasks) CHECK(task == s_tasks[0]);
+    // the oldest press in the queue waited until the first listener returned
+    CHECK_EQ(gamepad.maxDispatchLatency(), blocked_at + 1000000 - first_queued);
+    CHECK_EQ(gamepad.droppedEvents(), 8 * 11 - GAMEPAD_EVENT_QUEUE_SIZE);
+}
+
+TEST(dispatcher_already_started) {
+    test::Sim sim;
+    CHECK_EQ(sim.gamepad().startDispatcher(), 0);
+    errno = 0;
+    CHECK_EQ(sim.gamepad().startDispatcher(), INT32_MAX);
+    CHECK_EQ(errno, EEXIST);
+}
@@ -0,0 +1,124 @@
+#include "test.hpp"
+#include "gamepad/event_handler.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace {
+constexpr int PROBES = 4096;
+
+/// What happened to the listener with the same index
+struct ProbeState {
+        std::atomic<int> running = 0;
+        std::atomic<bool> destroyed = false;
+};
+
+ProbeState s_probes[PROBES];
+std::atomic<int> s_runs = 0;
+/// The number of times a listener was destroyed while it was running, or ran after it was destroyed
+std::atomic<int> s_violations = 0;
+
+/**
+ * @brief A listener that records when it runs and when it is destroyed, in the state at its index
+ */
+class Probe {
+    public:
+        explicit Probe(int index)
+            : m_index(index) {}
+
+        Probe(Probe&& other) noexcept
+            : m_index(other.m_index) {
+            other.m_index = -1;
+        }
+
+        ~Probe() {
+            if (m_index < 0) return;
+            if (s_probes[m_index].running.load() != 0) s_violations++;
+            s_probes[m_index].destroyed = true;
+        }
+
+        void operator()() {
+            ProbeState& state = s_probes[m_index];
+            state.running++;
+            if (state.destroyed.load()) s_violations++;
+            // give the other thread a chance to remove this listener while it runs
+            std::this_thread::yield();
+            if (state.destroyed.load()) s_violations++;
+            state.running--;
+            s_runs++;
+        }
+    private:
+        int m_index;
+};
+
+using Handler = gamepad::_impl::EventHandler<std::string, 4>;
+} // namespace
+
+TEST(event_handler_remove_while_firing) {
+    Handler handler;
+    std::atomic<bool> done = false;
+    std::thread firer([&] {
+        while (!done.load()) handler.fire();
+    });
+
+    int added = 0, rejected = 0;
+    for (int i = 0; i < PROBES; i++) {
+        gamepad::ListenerHandle handle = handler.addListener(Probe(i));
+        // slots retired by overlapping fires can fill up a handler this small for a moment
+        if (!handle.isValid()) {
+            rejected++;
+            std::this_thread::yield();
+            continue;
+        }
+        added++;
+        std::this_thread::yield();
+        CHECK_EQ(handler.removeListener(handle), 0);
+    }
+    done = true;
+    firer.join();
+
+    CHECK_EQ(s_violations.load(), 0);
+    CHECK_EQ(added + rejected, PROBES);
+    // the listeners have to have raced the removals for the check to mean anything
+    CHECK(added > 0);
+    CHECK(s_runs.load() > 0);
+
+    // once no fire is in progress, every removed listener is destroyed, and every slot can be used again
+    handler.fire();
+    for (int i = 0; i < PROBES; i++) CHECK(s_probes[i].destroyed.load());
+    for (int i = 0; i < 4; i++) CHECK(handler.addListener([] {}).isValid());
+    CHECK(!handler.addListener([] {}).isValid());
+}
+
+TEST(event_handler_retired_until_readers_finish) {
+    Handler handler;
+    std::atomic<bool> blocking = false, unblock = false;
+    handler.addListener([&] {
+        blocking = true;
+        while (!unblock.load()) std::this_thread::yield();
+    });
+    gamepad::ListenerHandle removed = handler.addListener(Probe(0));
+    CHECK(handler.addListener(Probe(1)).isValid());
+    CHECK(handler.addListener(Probe(2)).isValid());
+
+    std::thread firer([&] { handler.fire(); });
+    while (!blocking.load()) std::this_thread::yield();
+
+    // the fire in progress loaded the removed listener, so it is not destroyed, and its slot is not reused
+    CHECK_EQ(handler.removeListener(removed), 0);
+    CHECK(!s_probes[0].destroyed.load());
+    CHECK(!handler.addListener(Probe(3)).isValid());
+
+    // the fire still runs it, and frees the slot as it returns
+    unblock = true;
+    firer.join();
+    CHECK_EQ(s_runs.load(), 3);
+    CHECK_EQ(s_probes[0].running.load(), 0);
+    CHECK(s_probes[0].destroyed.load());
+    CHECK(!s_probes[1].destroyed.load());
+    gamepad::ListenerHandle reused = handler.addListener(Probe(4));
+    CHECK(reused.isValid());
+    CHECK_EQ(reused.slot, removed.slot);
+    CHECK(reused.generation != removed.generation);
+    CHECK_EQ(s_violations.load(), 0);
+}
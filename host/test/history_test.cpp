@@ -0,0 +1,50 @@
+#include "test.hpp"
+
+using namespace pros;
+
+TEST(history_queries) {
+    gamepad::InputHistory<8> history;
+    CHECK_EQ(history.size(), 0u);
+    CHECK(!history.wasPressed(E_CONTROLLER_DIGITAL_A, 1000));
+    CHECK_EQ(history.axisAverage(E_CONTROLLER_ANALOG_LEFT_X, 100), 0.0f);
+
+    const uint16_t a = 1 << (E_CONTROLLER_DIGITAL_A - E_CONTROLLER_DIGITAL_L1);
+    // 10 updates 10ms apart, with A held from the 4th to the 6th, and the left X axis counting up
+    for (int i = 0; i < 10; i++) {
+        const uint16_t buttons = i >= 3 && i <= 5 ? a : 0;
+        history.push(10000 * (i + 1), buttons, i == 3 ? a : 0, {int8_t(i), 0, 0, 0});
+    }
+    // only the last 8 are kept
+    CHECK_EQ(history.size(), 8u);
+
+    // A was pressed at 40ms, and the latest update is at 100ms
+    CHECK(history.wasPressed(E_CONTROLLER_DIGITAL_A, 60));
+    CHECK(!history.wasPressed(E_CONTROLLER_DIGITAL_A, 59));
+    CHECK(!history.wasPressed(E_CONTROLLER_DIGITAL_B, 100));
+
+    CHECK(!history.isPressedAt(E_CONTROLLER_DIGITAL_A, 39999));
+    CHECK(history.isPressedAt(E_CONTROLLER_DIGITAL_A, 40000));
+    CHECK(history.isPressedAt(E_CONTROLLER_DIGITAL_A, 69999));
+    CHECK(!history.isPressedAt(E_CONTROLLER_DIGITAL_A, 70000));
+    // older than the history, so the oldest update (at 30ms) is used
+    CHECK(!history.isPressedAt(E_CONTROLLER_DIGITAL_A, 0));
+
+    CHECK_EQ(history.axisAt(E_CONTROLLER_ANALOG_LEFT_X, 55000), 4 / 127.0f);
+    // the updates at 80, 90 and 100ms
+    CHECK_EQ(history.axisAverage(E_CONTROLLER_ANALOG_LEFT_X, 20), 24 / 127.0f / 3);
+    // longer than the history, so every update is averaged
+    CHECK_EQ(history.axisAverage(E_CONTROLLER_ANALOG_LEFT_X, 1000), 44 / 127.0f / 8);
+}
+
+TEST(history_from_update) {
+    test::Sim sim;
+    sim.run(100);
+    sim.press(E_CONTROLLER_DIGITAL_Y);
+    sim.step();
+    const uint64_t pressed = sim.now();
+    sim.run(50);
+    CHECK_EQ(sim.gamepad().history().size(), 16u);
+    CHECK(sim.gamepad().history().wasPressed(E_CONTROLLER_DIGITAL_Y, 50));
+    CHECK(sim.gamepad().history().isPressedAt(E_CONTROLLER_DIGITAL_Y, pressed));
+    CHECK(!sim.gamepad().history().isPressedAt(E_CONTROLLER_DIGITAL_Y, pressed - 1));
+}
@@ -0,0 +1,51 @@
+#include "test.hpp"
+#include "pros/rtos.h"
+
+namespace {
+std::vector<uint32_t> s_wakes;
+pros::task_t s_waiter = nullptr;
+} // namespace
+
+TEST(host_port_simulated_delay) {
+    pros::host::useSimulatedTime(0);
+    pros::c::task_create(
+        [](void*) {
+            uint32_t wake_time = pros::c::millis();
+            while (true) {
+                pros::c::task_delay_until(&wake_time, 5);
+                s_wakes.push_back(pros::c::millis());
+            }
+        },
+        nullptr, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "waker");
+    // the task wakes at every deadline on the way, not once at the end
+    pros::host::advanceTime(20000);
+    CHECK_EQ(s_wakes.size(), 4u);
+    for (std::size_t i = 0; i < s_wakes.size(); i++) CHECK_EQ(s_wakes[i], 5 * (i + 1));
+    // delay() on a thread that is not a task moves the clock too
+    pros::c::delay(7);
+    CHECK_EQ(pros::c::millis(), 27u);
+    CHECK_EQ(s_wakes.size(), 5u);
+}
+
+TEST(host_port_simulated_notify) {
+    pros::host::useSimulatedTime(0);
+    s_waiter = pros::c::task_create(
+        [](void*) {
+            while (true) {
+                const uint32_t notifications = pros::c::task_notify_take(true, 100);
+                s_wakes.push_back(notifications == 0 ? pros::c::millis() : 1000000 + pros::c::millis());
+            }
+        },
+        nullptr, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "waiter");
+    pros::host::advanceTime(50000);
+    CHECK(s_wakes.empty());
+    // a notification ends the wait early, without moving the clock
+    pros::c::task_notify(s_waiter);
+    pros::host::waitForTasks();
+    CHECK_EQ(s_wakes.size(), 1u);
+    CHECK_EQ(s_wakes[0], 1000050u);
+    // and without one, the wait times out
+    pros::host::advanceTime(100000);
+    CHECK_EQ(s_wakes.size(), 2u);
+    CHECK_EQ(s_wakes[1], 150u);
+}
@@ -0,0 +1,210 @@
+#include "test.hpp"
+#include <unistd.h>
+
+using namespace pros;
+
+namespace {
+/**
+ * @brief Get a path for a log file that is deleted at the end of the test
+ */
+struct TempFile {
+        TempFile() { std::snprintf(path, sizeof(path), "/tmp/gamepad_test_%d.gpil", int(getpid())); }
+
+        ~TempFile() { std::remove(path); }
+
+        char path[64];
+};
+
+gamepad::InputFrame frame(uint64_t timestamp, uint16_t buttons, int8_t axis) {
+    gamepad::InputFrame frame;
+    frame.timestamp = timestamp;
+    frame.buttons = buttons;
+    frame.axes = {axis, int8_t(-axis), 0, 0};
+    return frame;
+}
+
+bool operator==(const gamepad::InputFrame& a, const gamepad::InputFrame& b) {
+    return a.timestamp == b.timestamp && a.buttons == b.buttons && a.toggled == b.toggled && a.axes == b.axes &&
+           a.connected == b.connected;
+}
+
+std::vector<gamepad::InputFrame> frames(std::size_t count) {
+    std::vector<gamepad::InputFrame> frames;
+    for (std::size_t i = 0; i < count; i++) {
+        frames.push_back(frame(1000000 + i * 10000, (i / 7) & 0xfff, int8_t(i % 255 - 127)));
+        if (i % 13 == 0) frames.back().toggled = 1;
+        if (i % 101 == 0) frames.back().connected = false;
+    }
+    return frames;
+}
+} // namespace
+
+TEST(input_log_round_trip) {
+    TempFile file;
+    const std::vector<gamepad::InputFrame> written = frames(2000);
+    {
+        // a keyframe every 100ms, so the index has plenty of entries
+        gamepad::InputLogWriter writer(100, 1024);
+        CHECK_EQ(writer.open(file.path), 0);
+        for (const gamepad::InputFrame& frame : written) {
+            writer.record(frame);
+            if (frame.buttons & 1) writer.recordEvents(frame.timestamp, E_CONTROLLER_DIGITAL_A, 0b101);
+            if (writer.bufferedBytes() > 512) CHECK_EQ(writer.flush(), 0);
+        }
+        CHECK_EQ(writer.close(), 0);
+        CHECK_EQ(writer.droppedFrames(), 0u);
+        CHECK_EQ(writer.droppedEvents(), 0u);
+    }
+
+    gamepad::InputLogReader reader;
+    CHECK_EQ(reader.open(file.path), 0);
+    CHECK_EQ(reader.startTime(), written.front().timestamp);
+    CHECK_EQ(reader.endTime(), written.back().timestamp);
+
+    gamepad::InputFrame read;
+    for (const gamepad::InputFrame& frame : written) {
+        CHECK(reader.read(read));
+        CHECK(read == frame);
+        if (frame.buttons & 1) {
+            CHECK_EQ(reader.events().size(), 1u);
+            CHECK_EQ(reader.events()[0].button, E_CONTROLLER_DIGITAL_A);
+            CHECK_EQ(reader.events()[0].events, 0b101);
+        } else {
+            CHECK(reader.events().empty());
+        }
+    }
+    CHECK(!reader.read(read));
+
+    // seeking lands on the first frame at or after the time, and reads on from there
+    for (std::size_t i : {0, 1, 99, 100, 1234, 1999}) {
+        CHECK_EQ(reader.seek(written[i].timestamp - 1), 0);
+        for (std::size_t j = i; j < std::min<std::size_t>(i + 20, written.size()); j++) {
+            CHECK(reader.read(read));
+            CHECK(read == written[j]);
+        }
+    }
+    CHECK_EQ(reader.seek(written.back().timestamp + 1), 0);
+    CHECK(!reader.read(read));
+}
+
+TEST(input_log_without_index) {
+    TempFile file;
+    const std::vector<gamepad::InputFrame> written = frames(300);
+    {
+        gamepad::InputLogWriter writer(100, 1 << 16);
+        CHECK_EQ(writer.open(file.path), 0);
+        for (const gamepad::InputFrame& frame : written) writer.record(frame);
+        // flush without closing, as if the program was stopped in the middle of a match
+        CHECK_EQ(writer.flush(), 0);
+        std::FILE* copy = std::fopen(file.path, "rb");
+        CHECK(copy != nullptr);
+        std::vector<uint8_t> contents(1 << 16);
+        contents.resize(std::fread(contents.data(), 1, contents.size(), copy));
+        std::fclose(copy);
+        CHECK_EQ(writer.close(), 0);
+        copy = std::fopen(file.path, "wb");
+        std::fwrite(contents.data(), 1, contents.size(), copy);
+        std::fclose(copy);
+    }
+
+    gamepad::InputLogReader reader;
+    CHECK_EQ(reader.open(file.path), 0);
+    CHECK_EQ(reader.startTime(), written.front().timestamp);
+    CHECK_EQ(reader.endTime(), written.back().timestamp);
+    CHECK_EQ(reader.seek(written[150].timestamp), 0);
+    gamepad::InputFrame read;
+    CHECK(reader.read(read));
+    CHECK(read == written[150]);
+}
+
+TEST(input_log_index_full) {
+    TempFile file;
+    std::vector<gamepad::InputFrame> written = frames(1000);
+    // a gap in the updates delays the keyframes after it
+    for (std::size_t i = 500; i < written.size(); i++) written[i].timestamp += 1234567;
+    {
+        // 10 keyframes are written, but only the first 4 fit in the index
+        gamepad::InputLogWriter writer(1000, 1 << 16, 4);
+        CHECK_EQ(writer.open(file.path), 0);
+        for (const gamepad::InputFrame& frame : written) writer.record(frame);
+        CHECK_EQ(writer.close(), 0);
+    }
+
+    gamepad::InputLogReader reader;
+    CHECK_EQ(reader.open(file.path), 0);
+    CHECK_EQ(reader.endTime(), written.back().timestamp);
+    gamepad::InputFrame read;
+    for (std::size_t i : {0, 250, 499, 500, 501, 999}) {
+        CHECK_EQ(reader.seek(written[i].timestamp), 0);
+        CHECK(reader.read(read));
+        CHECK(read == written[i]);
+    }
+    // a time in the gap lands on the first frame after it
+    CHECK_EQ(reader.seek(written[499].timestamp + 1000000), 0);
+    CHECK(reader.read(read));
+    CHECK(read == written[500]);
+}
+
+TEST(input_log_flush_task) {
+    TempFile file;
+    const std::vector<gamepad::InputFrame> written = frames(5000);
+    {
+        gamepad::InputLogWriter writer(100, 256);
+        CHECK_EQ(writer.open(file.path), 0);
+        CHECK_EQ(writer.startFlushing(), 0);
+        CHECK_EQ(writer.startFlushing(), INT32_MAX);
+        for (const gamepad::InputFrame& frame : written) {
+            writer.record(frame);
+            // give the flush task time to write, like the control loop does between updates
+            if (writer.bufferedBytes() > 200) pros::c::delay(1);
+        }
+        CHECK_EQ(writer.close(), 0);
+        CHECK_EQ(writer.droppedFrames(), 0u);
+    }
+
+    gamepad::InputLogReader reader;
+    CHECK_EQ(reader.open(file.path), 0);
+    gamepad::InputFrame read;
+    for (const gamepad::InputFrame& frame : written) {
+        CHECK(reader.read(read));
+        CHECK(read == frame);
+    }
+    CHECK(!reader.read(read));
+}
+
+TEST(input_log_versions) {
+    TempFile file;
+    {
+        gamepad::InputLogWriter writer;
+        CHECK_EQ(writer.open(file.path), 0);
+        writer.record(frame(1000, 1, 0));
+        CHECK_EQ(writer.close(), 0);
+    }
+    // version 1 logs have no events, and are otherwise read the same way, but newer versions are not understood
+    auto open = [&](uint8_t version) {
+        std::FILE* log = std::fopen(file.path, "r+b");
+        std::fseek(log, 4, SEEK_SET);
+        std::fputc(version, log);
+        std::fclose(log);
+        gamepad::InputLogReader reader;
+        return reader.open(file.path);
+    };
+    CHECK_EQ(open(1), 0);
+    CHECK_EQ(open(2), 0);
+    CHECK_EQ(open(3), INT32_MAX);
+    CHECK_EQ(open(0), INT32_MAX);
+}
+
+TEST(input_log_invalid) {
+    TempFile file;
+    std::FILE* garbage = std::fopen(file.path, "wb");
+    std::fputs("not an input log", garbage);
+    std::fclose(garbage);
+    gamepad::InputLogReader reader;
+    errno = 0;
+    CHECK_EQ(reader.open(file.path), INT32_MAX);
+    CHECK_EQ(errno, EINVAL);
+    errno = 0;
+    CHECK_EQ(reader.seek(0), INT32_MAX);
+    CHECK_EQ(errno, EBADF);
+}
@@ -0,0 +1,131 @@
+#include "test.hpp"
+#include <memory>
+#include <string>
+
+using namespace pros;
+
+namespace {
+struct Event {
+        std::string name;
+        uint64_t time;
+};
+
+std::vector<Event> s_events;
+
+void listen(test::Sim& sim) {
+    auto log = [&sim](const char* name) {
+        return [&sim, name] { s_events.push_back({name, sim.gamepad().snapshot().timestamp}); };
+    };
+    sim.gamepad().buttonA().onPress("press", log("press"));
+    sim.gamepad().buttonA().onLongPress("longPress", log("longPress"));
+    sim.gamepad().buttonA().onRepeatPress("repeat", log("repeat"));
+    sim.gamepad().buttonA().onRelease("release", log("release"));
+    sim.gamepad().buttonB().onDoubleTap("doubleTap", log("doubleTap"));
+    sim.gamepad().onChord("chord", {E_CONTROLLER_DIGITAL_L1, E_CONTROLLER_DIGITAL_R1}, log("chord"));
+    sim.gamepad().onSequence("sequence", {E_CONTROLLER_DIGITAL_UP, E_CONTROLLER_DIGITAL_DOWN}, log("sequence"));
+}
+
+/**
+ * @brief Press every kind of input the listeners above are waiting for
+ */
+void play(test::Sim& sim) {
+    sim.run(100);
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    sim.run(700);
+    sim.release(E_CONTROLLER_DIGITAL_A);
+    sim.run(100);
+    for (int i = 0; i < 2; i++) {
+        sim.press(E_CONTROLLER_DIGITAL_B);
+        sim.run(50);
+        sim.release(E_CONTROLLER_DIGITAL_B);
+        sim.run(50);
+    }
+    sim.press(E_CONTROLLER_DIGITAL_L1);
+    sim.step();
+    sim.press(E_CONTROLLER_DIGITAL_R1);
+    sim.run(100);
+    sim.release(E_CONTROLLER_DIGITAL_L1);
+    sim.release(E_CONTROLLER_DIGITAL_R1);
+    sim.run(100);
+    sim.press(E_CONTROLLER_DIGITAL_UP);
+    sim.run(50);
+    sim.release(E_CONTROLLER_DIGITAL_UP);
+    sim.run(50);
+    sim.press(E_CONTROLLER_DIGITAL_DOWN);
+    sim.run(50);
+    sim.release(E_CONTROLLER_DIGITAL_DOWN);
+    sim.run(500);
+}
+
+/**
+ * @brief Check that two runs fired the same events, the same time apart
+ */
+void checkSame(const std::vector<Event>& recorded, const std::vector<Event>& replayed) {
+    CHECK_EQ(replayed.size(), recorded.size());
+    for (std::size_t i = 0; i < recorded.size(); i++) {
+        CHECK(replayed[i].name == recorded[i].name);
+        if (i != 0) CHECK_EQ(replayed[i].time - replayed[i - 1].time, recorded[i].time - recorded[i - 1].time);
+    }
+}
+} // namespace
+
+TEST(input_source_record_replay) {
+    test::Sim sim;
+    listen(sim);
+    auto recorder = std::make_shared<gamepad::InputRecorder>(1000);
+    sim.gamepad().setInputSink(recorder);
+    play(sim);
+    sim.gamepad().setInputSink(nullptr);
+    const std::vector<Event> recorded = std::move(s_events);
+    s_events.clear();
+    // a press, a long press, 4 repeats, a release, a double tap, a chord and a sequence
+    CHECK_EQ(recorded.size(), 10u);
+    CHECK_EQ(recorder->droppedFrames(), 0u);
+
+    // keep the live gamepad running for a while, so the recording is far in the past by the time it is replayed
+    sim.run(60000);
+    const uint64_t before = sim.gamepad().snapshot().timestamp;
+    auto replay = std::make_shared<gamepad::ReplaySource>(recorder->frames());
+    sim.gamepad().setInputSource(replay);
+    uint64_t last = before;
+    while (!replay->finished()) {
+        sim.step();
+        // time continues from the last live update, instead of going back to the recording
+        CHECK(sim.gamepad().snapshot().timestamp >= last);
+        last = sim.gamepad().snapshot().timestamp;
+    }
+    checkSame(recorded, s_events);
+    CHECK(s_events.front().time >= before);
+    CHECK(sim.gamepad().buttonA().time_released < 60000);
+
+    // and back to the controller, which is now behind the replay
+    sim.gamepad().setInputSource(nullptr);
+    sim.step();
+    CHECK(sim.gamepad().snapshot().timestamp >= last);
+    s_events.clear();
+    play(sim);
+    checkSame(recorded, s_events);
+}
+
+TEST(input_source_clock_goes_backwards) {
+    test::Sim sim;
+    listen(sim);
+    sim.run(60000);
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    sim.run(200);
+
+    // a new clock that starts over from 0, in the middle of a long press
+    gamepad::SimulatedClock restarted {0};
+    gamepad::setClock(&restarted);
+    for (int i = 0; i < 50; i++) {
+        restarted.advance(test::Sim::FRAME * 1000);
+        sim.gamepad().update();
+    }
+    // the first update on the new clock continues from the last one, so A has been held for 49 more updates
+    CHECK_EQ(sim.gamepad().buttonA().time_held, 190u + 49 * test::Sim::FRAME);
+    // a press, a long press and 4 repeats
+    CHECK_EQ(s_events.size(), 6u);
+    CHECK(s_events[1].name == "longPress");
+    CHECK_EQ(s_events[1].time - s_events[0].time, 500000u);
+    gamepad::setClock(nullptr);
+}
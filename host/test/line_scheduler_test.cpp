@@ -0,0 +1,111 @@
+#include "gamepad/screens/lineScheduler.hpp"
+#include "test.hpp"
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+using gamepad::_impl::LineScheduler;
+
+TEST(line_scheduler_round_robin) {
+    LineScheduler scheduler;
+    CHECK_EQ(scheduler.pick(0, 0), LineScheduler::LINE_COUNT);
+    for (uint8_t line = 0; line < LineScheduler::LINE_COUNT; line++) scheduler.markPending(line, 0, 100);
+    // equal lines go in order from the start
+    CHECK_EQ(scheduler.pick(2, 100), 2);
+    CHECK_EQ(scheduler.pick(0, 100), 0);
+    scheduler.cancel(0);
+    CHECK_EQ(scheduler.pick(0, 100), 1);
+    scheduler.cancelAll();
+    CHECK_EQ(scheduler.pick(0, 100), LineScheduler::LINE_COUNT);
+}
+
+TEST(line_scheduler_staleness_and_rank) {
+    LineScheduler scheduler;
+    scheduler.markPending(1, 0, 0);
+    scheduler.markPending(2, 0, 30);
+    // marking a line that is already pending does not reset how long it has waited
+    scheduler.markPending(1, 0, 40);
+    CHECK_EQ(scheduler.pick(2, 40), 1);
+
+    // one rank is worth one write interval of waiting
+    scheduler.markPending(3, 1, 40);
+    CHECK_EQ(scheduler.pick(0, 40), 3);
+    scheduler.cancel(3);
+    scheduler.markPending(3, 1, 40 + LineScheduler::WRITE_INTERVAL + 1);
+    CHECK_EQ(scheduler.pick(0, 40 + LineScheduler::WRITE_INTERVAL + 1), 1);
+}
+
+TEST(line_scheduler_deadline) {
+    LineScheduler scheduler;
+    scheduler.setDeadline(2, 60);
+    scheduler.markPending(0, 5, 0);
+    scheduler.markPending(2, 0, 0);
+    CHECK_EQ(scheduler.pick(0, 0), 0);
+    // once the deadline can not wait for another write, the line wins over any rank
+    CHECK_EQ(scheduler.pick(0, 11), 2);
+
+    scheduler.written(2, 11);
+    scheduler.markPending(2, 0, 20);
+    scheduler.written(2, 100);
+    const gamepad::LineStats& stats = scheduler.stats(2);
+    CHECK_EQ(stats.writes, 2u);
+    CHECK_EQ(stats.last, 80u);
+    CHECK_EQ(stats.max, 80u);
+    CHECK_EQ(stats.total, 91u);
+    CHECK_EQ(stats.missed_deadlines, 1u);
+}
+
+TEST(line_scheduler_rank) {
+    CHECK_EQ(LineScheduler::rank(0), 0u);
+    CHECK_EQ(LineScheduler::rank(1), 1u);
+    CHECK_EQ(LineScheduler::rank(2), 2u);
+    CHECK_EQ(LineScheduler::rank(3), 2u);
+    CHECK_EQ(LineScheduler::rank(UINT32_MAX - 100), 32u);
+}
+
+namespace {
+/// Update the gamepad until the first of the given lines shows the text given for it, and return that line
+uint8_t stepUntilShown(test::Sim& sim, std::initializer_list<std::pair<uint8_t, const char*>> lines) {
+    for (int frame = 0; frame < 100; frame++) {
+        sim.step();
+        for (const auto& [line, text] : lines) {
+            if (pros::host::getText(pros::E_CONTROLLER_MASTER, line).starts_with(text)) return line;
+        }
+    }
+    return LineScheduler::LINE_COUNT;
+}
+} // namespace
+
+TEST(line_scheduler_gamepad_deadline) {
+    test::Sim sim;
+    CHECK_EQ(sim.gamepad().setLineDeadline(1, 40), 0);
+    sim.gamepad().printLine(0, "start");
+    sim.run(500);
+
+    // lines 0 and 2 wait for the same write slot, and the one that loses it is staler than line 1 at the next one
+    sim.gamepad().printLine(0, "zero");
+    sim.gamepad().printLine(2, "two");
+    const uint8_t first = stepUntilShown(sim, {{0, "zero"}, {2, "two"}});
+    CHECK(first == 0 || first == 2);
+    const uint8_t stale = first == 0 ? 2 : 0;
+    sim.gamepad().printLine(1, "one");
+
+    // line 1 can not wait for another write without missing its deadline, so it goes first
+    CHECK_EQ(stepUntilShown(sim, {{stale, stale == 0 ? "zero" : "two"}, {1, "one"}}), 1);
+    CHECK_EQ(stepUntilShown(sim, {{stale, stale == 0 ? "zero" : "two"}}), stale);
+    CHECK_EQ(sim.gamepad().lineStats(1).writes, 1u);
+    CHECK_EQ(sim.gamepad().lineStats(1).missed_deadlines, 0u);
+    CHECK(sim.gamepad().lineStats(stale).last > sim.gamepad().lineStats(1).last);
+
+    // when two lines can not both make their deadline, the one written second records a miss
+    CHECK_EQ(sim.gamepad().setLineDeadline(0, 10), 0);
+    CHECK_EQ(sim.gamepad().setLineDeadline(2, 10), 0);
+    sim.gamepad().printLine(0, "late zero");
+    sim.gamepad().printLine(2, "late two");
+    sim.run(500);
+    CHECK(pros::host::getText(pros::E_CONTROLLER_MASTER, 0).starts_with("late zero"));
+    CHECK(pros::host::getText(pros::E_CONTROLLER_MASTER, 2).starts_with("late two"));
+    const gamepad::LineStats zero = sim.gamepad().lineStats(0), two = sim.gamepad().lineStats(2);
+    CHECK_EQ(zero.missed_deadlines + two.missed_deadlines, 1u);
+    CHECK(std::max(zero.last, two.last) > 10);
+}
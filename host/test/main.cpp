@@ -0,0 +1,45 @@
+/**
+ * Runs the behavior tests of the library on the host port.
+ *
+ *   make -C host test
+ *   host/build/gamepad_test [name...]
+ *
+ * Each test runs in a child process, so a crash or a failed check only fails that test. Passing names only runs the
+ * tests whose name contains one of them.
+ */
+#include "test.hpp"
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace test {
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+} // namespace test
+
+int main(int argc, char** argv) {
+    int passed = 0, failed = 0;
+    for (const test::TestCase& test : test::registry()) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++) selected = selected || std::strstr(test.name, argv[i]) != nullptr;
+        if (!selected) continue;
+
+        std::fflush(stdout);
+        pid_t child = fork();
+        if (child == 0) {
+            test.body();
+            std::fflush(nullptr);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        const bool ok = child > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!ok && WIFSIGNALED(status)) std::fprintf(stderr, "  killed by signal %d\n", WTERMSIG(status));
+        std::printf("%s %s\n", ok ? "PASS" : "FAIL", test.name);
+        (ok ? passed : failed)++;
+    }
+    std::printf("%d passed, %d failed\n", passed, failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#include "test.hpp"
+#include "gamepad/recursive_mutex.hpp"
+#include <cerrno>
+
+TEST(recursive_mutex_creation_fails) {
+    gamepad::_impl::RecursiveMutex mutex;
+    const uint32_t count = gamepad::_impl::RecursiveMutex::count();
+    pros::host::failMutexCreation(2);
+
+    // the mutex is not locked, or counted, while its kernel object can not be created
+    errno = 0;
+    CHECK(!mutex.try_lock());
+    CHECK_EQ(errno, ENOMEM);
+    CHECK(!mutex.take(10));
+    CHECK(!mutex.give());
+    CHECK_EQ(gamepad::_impl::RecursiveMutex::count(), count);
+
+    // and the next lock creates it
+    CHECK(mutex.try_lock());
+    CHECK(mutex.try_lock());
+    CHECK_EQ(gamepad::_impl::RecursiveMutex::count(), count + 1);
+    CHECK(mutex.give());
+    CHECK(mutex.give());
+}
@@ -0,0 +1,66 @@
+#include "test.hpp"
+#include <cerrno>
+
+using namespace pros;
+
+namespace {
+int s_presses = 0, s_releases = 0;
+
+void listen(const gamepad::Button& button) {
+    button.onPress("press", [] { s_presses++; });
+    button.onRelease("release", [] { s_releases++; });
+}
+} // namespace
+
+TEST(sampler_tap_between_updates) {
+    test::Sim sim;
+    listen(sim.gamepad().buttonA());
+    CHECK_EQ(sim.gamepad().startSampling(2), 0);
+    sim.step();
+
+    // a tap that starts and ends between two updates is only seen by the sampler
+    host::advanceTime(3000);
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    host::advanceTime(4000);
+    sim.release(E_CONTROLLER_DIGITAL_A);
+    sim.step(3);
+    CHECK_EQ(s_presses, 1);
+    CHECK_EQ(s_releases, 1);
+    CHECK(!sim.gamepad().buttonA().is_pressed);
+    sim.run(100);
+    CHECK_EQ(s_presses, 1);
+    CHECK_EQ(s_releases, 1);
+
+    // and so is letting go of a held button for a moment
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    sim.step();
+    host::advanceTime(3000);
+    sim.release(E_CONTROLLER_DIGITAL_A);
+    host::advanceTime(4000);
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    sim.step(3);
+    CHECK_EQ(s_presses, 3);
+    CHECK_EQ(s_releases, 2);
+    CHECK(sim.gamepad().buttonA().is_pressed);
+}
+
+TEST(sampler_tap_missed_without_sampler) {
+    test::Sim sim;
+    listen(sim.gamepad().buttonA());
+    sim.step();
+    host::advanceTime(3000);
+    sim.press(E_CONTROLLER_DIGITAL_A);
+    host::advanceTime(4000);
+    sim.release(E_CONTROLLER_DIGITAL_A);
+    sim.step(3);
+    CHECK_EQ(s_presses, 0);
+    CHECK_EQ(s_releases, 0);
+}
+
+TEST(sampler_already_started) {
+    test::Sim sim;
+    CHECK_EQ(sim.gamepad().startSampling(), 0);
+    errno = 0;
+    CHECK_EQ(sim.gamepad().startSampling(), INT32_MAX);
+    CHECK_EQ(errno, EEXIST);
+}
@@ -0,0 +1,80 @@
+#include "test.hpp"
+
+using namespace pros;
+
+TEST(screen_print_lines) {
+    test::Sim sim;
+    sim.gamepad().printLine(0, "first\nsecond");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("first "));
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 1).starts_with("second "));
+
+    // a trailing newline does not blank the line after it, and an empty line in the middle is left alone too
+    sim.gamepad().printLine(0, "fourth\n\nfifth");
+    sim.gamepad().printLine(1, "third\n");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("fourth "));
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 1).starts_with("third "));
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 2).starts_with("fifth "));
+}
+
+TEST(screen_end_of_line) {
+    test::Sim sim;
+    sim.gamepad().printLine(0, "abcdefghijklmnopqrs");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0) == "abcdefghijklmnopqrs");
+    // only the last column changed, but the write can not start past column 14
+    const uint32_t writes = pros::host::getWriteCount(E_CONTROLLER_MASTER);
+    sim.gamepad().printLine(0, "abcdefghijklmnopqrS");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0) == "abcdefghijklmnopqrS");
+    CHECK_EQ(pros::host::getWriteCount(E_CONTROLLER_MASTER), writes + 1);
+}
+
+TEST(screen_failed_writes) {
+    test::Sim sim;
+    sim.gamepad().printLine(0, "hello");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("hello "));
+
+    // writes that the controller does not take are retried in the next write slots
+    pros::host::failWrites(E_CONTROLLER_MASTER, 3);
+    sim.gamepad().printLine(0, "world");
+    sim.gamepad().rumble("-");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("world "));
+    CHECK(pros::host::getRumble(E_CONTROLLER_MASTER) == "-");
+    CHECK_EQ(sim.gamepad().lineStats(0).writes, 2u);
+    CHECK_EQ(sim.gamepad().lineStats(3).writes, 1u);
+}
+
+TEST(screen_failed_clear) {
+    test::Sim sim;
+    pros::host::failWrites(E_CONTROLLER_MASTER, 1);
+    sim.gamepad().printLine(1, "after clear");
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 1).starts_with("after clear "));
+}
+
+TEST(screen_time_passes_while_disconnected) {
+    test::Sim sim;
+    auto alerts = std::make_shared<gamepad::AlertScreen>();
+    sim.gamepad().addScreen(alerts);
+    alerts->addAlerts(0, "first", 1000);
+    alerts->addAlerts(0, "second", 1000);
+    sim.run(200);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("first "));
+
+    // the first alert runs out while the controller is disconnected, and nothing is written in the meantime
+    host::setConnected(E_CONTROLLER_MASTER, false);
+    const uint32_t writes = host::getWriteCount(E_CONTROLLER_MASTER);
+    sim.run(2000);
+    CHECK_EQ(host::getWriteCount(E_CONTROLLER_MASTER), writes);
+
+    // so the second alert is shown soon after the reconnect, for its whole duration
+    host::setConnected(E_CONTROLLER_MASTER, true);
+    sim.run(300);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("second "));
+    sim.run(500);
+    CHECK(pros::host::getText(E_CONTROLLER_MASTER, 0).starts_with("second "));
+}
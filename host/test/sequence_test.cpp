@@ -0,0 +1,127 @@
+#include "test.hpp"
+#include <cerrno>
+#include <string>
+
+using namespace pros;
+
+namespace {
+void tap(test::Sim& sim, controller_digital_e_t button, uint32_t gap = 50) {
+    sim.press(button);
+    sim.run(50);
+    sim.release(button);
+    sim.run(gap);
+}
+} // namespace
+
+TEST(sequence_recognized) {
+    test::Sim sim;
+    int hangs = 0;
+    CHECK_EQ(sim.gamepad().onSequence("hang", {E_CONTROLLER_DIGITAL_UP, E_CONTROLLER_DIGITAL_UP,
+                                               E_CONTROLLER_DIGITAL_DOWN},
+                                      [&] { hangs++; }),
+             0);
+    sim.step();
+    tap(sim, E_CONTROLLER_DIGITAL_UP);
+    tap(sim, E_CONTROLLER_DIGITAL_UP);
+    CHECK_EQ(hangs, 0);
+    tap(sim, E_CONTROLLER_DIGITAL_DOWN);
+    CHECK_EQ(hangs, 1);
+
+    // a longer run of the first button still ends in the sequence
+    tap(sim, E_CONTROLLER_DIGITAL_UP);
+    tap(sim, E_CONTROLLER_DIGITAL_UP);
+    tap(sim, E_CONTROLLER_DIGITAL_UP);
+    tap(sim, E_CONTROLLER_DIGITAL_DOWN);
+    CHECK_EQ(hangs, 2);
+}
+
+TEST(sequence_overlapping) {
+    test::Sim sim;
+    int abc = 0, bc = 0, ab = 0;
+    sim.gamepad().onSequence("abc", {E_CONTROLLER_DIGITAL_A, E_CONTROLLER_DIGITAL_B, E_CONTROLLER_DIGITAL_X},
+                             [&] { abc++; });
+    sim.gamepad().onSequence("bc", {E_CONTROLLER_DIGITAL_B, E_CONTROLLER_DIGITAL_X}, [&] { bc++; });
+    sim.gamepad().onSequence("ab", {E_CONTROLLER_DIGITAL_A, E_CONTROLLER_DIGITAL_B}, [&] { ab++; });
+    sim.step();
+    // A B completes "ab", which starts recognition over, so the X that follows completes nothing
+    tap(sim, E_CONTROLLER_DIGITAL_A);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    tap(sim, E_CONTROLLER_DIGITAL_X);
+    CHECK_EQ(ab, 1);
+    CHECK_EQ(abc, 0);
+    CHECK_EQ(bc, 0);
+
+    CHECK_EQ(sim.gamepad().removeSequence("ab"), 0);
+    CHECK_EQ(sim.gamepad().removeSequence("ab"), INT32_MAX);
+    tap(sim, E_CONTROLLER_DIGITAL_A);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    tap(sim, E_CONTROLLER_DIGITAL_X);
+    CHECK_EQ(abc, 1);
+    CHECK_EQ(ab, 1);
+    // sequences that end on the same press are all recognized
+    CHECK_EQ(bc, 1);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    tap(sim, E_CONTROLLER_DIGITAL_X);
+    CHECK_EQ(bc, 2);
+}
+
+TEST(sequence_timeout) {
+    test::Sim sim;
+    int hits = 0;
+    sim.gamepad().onSequence("ab", {E_CONTROLLER_DIGITAL_A, E_CONTROLLER_DIGITAL_B}, [&] { hits++; });
+    sim.gamepad().setSequenceTimeout(200);
+    sim.step();
+    tap(sim, E_CONTROLLER_DIGITAL_A, 300);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    CHECK_EQ(hits, 0);
+    tap(sim, E_CONTROLLER_DIGITAL_A, 100);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    CHECK_EQ(hits, 1);
+}
+
+TEST(sequence_invalid) {
+    test::Sim sim;
+    errno = 0;
+    CHECK_EQ(sim.gamepad().onSequence("empty", {}, [] {}), INT32_MAX);
+    CHECK_EQ(errno, EINVAL);
+    CHECK_EQ(sim.gamepad().onSequence("a", {E_CONTROLLER_DIGITAL_A}, [] {}), 0);
+    CHECK_EQ(sim.gamepad().onSequence("a", {E_CONTROLLER_DIGITAL_B}, [] {}), INT32_MAX);
+}
+
+TEST(sequence_limits) {
+    test::Sim sim;
+    errno = 0;
+    CHECK_EQ(sim.gamepad().onSequence("a", {E_CONTROLLER_DIGITAL_A}, [] {}), 0);
+    CHECK_EQ(sim.gamepad().onSequence("a", {E_CONTROLLER_DIGITAL_B}, [] {}), INT32_MAX);
+    CHECK_EQ(errno, EEXIST);
+    for (int i = 1; i < GAMEPAD_MAX_SEQUENCES; i++) {
+        CHECK_EQ(sim.gamepad().onSequence("a" + std::to_string(i), {E_CONTROLLER_DIGITAL_A}, [] {}), 0);
+    }
+    CHECK_EQ(sim.gamepad().onSequence("full", {E_CONTROLLER_DIGITAL_A}, [] {}), INT32_MAX);
+    CHECK_EQ(errno, ENOMEM);
+    for (int i = 1; i < GAMEPAD_MAX_SEQUENCES; i++) CHECK_EQ(sim.gamepad().removeSequence("a" + std::to_string(i)), 0);
+
+    // the automaton can not have more states than its 16 bit state indices can address
+    std::vector<controller_digital_e_t> longest(gamepad::_impl::SequenceRecognizer::MAX_STATES - 2,
+                                                E_CONTROLLER_DIGITAL_B);
+    CHECK_EQ(sim.gamepad().onSequence("longest", longest, [] {}), 0);
+    CHECK_EQ(sim.gamepad().onSequence("b", {E_CONTROLLER_DIGITAL_B}, [] {}), INT32_MAX);
+    CHECK_EQ(errno, E2BIG);
+    CHECK_EQ(sim.gamepad().removeSequence("longest"), 0);
+    CHECK_EQ(sim.gamepad().onSequence("b", {E_CONTROLLER_DIGITAL_B}, [] {}), 0);
+}
+
+TEST(sequence_removed_by_listener) {
+    test::Sim sim;
+    int hits = 0;
+    sim.gamepad().onSequence("ab", {E_CONTROLLER_DIGITAL_A, E_CONTROLLER_DIGITAL_B}, [&] {
+        hits++;
+        sim.gamepad().removeSequence("ab");
+    });
+    sim.step();
+    tap(sim, E_CONTROLLER_DIGITAL_A);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    tap(sim, E_CONTROLLER_DIGITAL_A);
+    tap(sim, E_CONTROLLER_DIGITAL_B);
+    CHECK_EQ(hits, 1);
+}
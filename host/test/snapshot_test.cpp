@@ -0,0 +1,62 @@
+#include "test.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace pros;
+
+namespace {
+/// The value every axis is set to for the update that publishes the given frame
+int32_t axisValue(uint32_t frame, int axis) { return int32_t((frame + axis * 31) % 255) - 127; }
+
+/// The buttons that are held down for the update that publishes the given frame
+uint16_t buttonsFor(uint32_t frame) { return frame & 0xFFF; }
+} // namespace
+
+TEST(snapshot_never_torn) {
+    test::Sim sim;
+    constexpr uint32_t UPDATES = 2000;
+    const uint64_t start = sim.now();
+    std::atomic<bool> done = false;
+    std::atomic<uint32_t> reads = 0, torn = 0, frames_seen = 0;
+
+    // every field of a snapshot is derived from its frame, so a snapshot mixed from two updates does not add up
+    std::thread reader([&] {
+        uint32_t last_frame = UINT32_MAX;
+        while (!done.load()) {
+            const gamepad::InputSnapshot snapshot = sim.gamepad().snapshot();
+            if (snapshot.timestamp == 0) continue;
+            bool consistent = snapshot.timestamp == start + uint64_t(snapshot.frame + 1) * test::Sim::FRAME * 1000 &&
+                              snapshot.buttons == buttonsFor(snapshot.frame);
+            for (int axis = 0; axis < 4; axis++) {
+                const float expected = axisValue(snapshot.frame, axis) / 127.0;
+                consistent = consistent && snapshot.axes[axis] == expected &&
+                             snapshot.transformed_axes[axis] == expected;
+            }
+            if (!consistent) torn++;
+            if (snapshot.frame != last_frame) frames_seen++;
+            last_frame = snapshot.frame;
+            reads++;
+        }
+    });
+
+    for (uint32_t frame = 0; frame < UPDATES; frame++) {
+        for (int axis = 0; axis < 4; axis++) {
+            host::setAnalog(E_CONTROLLER_MASTER, static_cast<controller_analog_e_t>(axis), axisValue(frame, axis));
+        }
+        for (int i = 0; i < 12; i++) {
+            const auto button = static_cast<controller_digital_e_t>(E_CONTROLLER_DIGITAL_L1 + i);
+            host::setDigital(E_CONTROLLER_MASTER, button, buttonsFor(frame) & (1 << i));
+        }
+        sim.step();
+        // on a single core, give the reader a chance to run between updates
+        std::this_thread::yield();
+    }
+    done = true;
+    reader.join();
+
+    CHECK_EQ(torn.load(), 0u);
+    CHECK_EQ(sim.gamepad().snapshot().frame, UPDATES - 1);
+    // the reader has to have raced the updates for the check to mean anything
+    CHECK(reads.load() > 0);
+    CHECK(frames_seen.load() > 1);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "gamepad/api.hpp"
+#include "pros_host.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * @brief A minimal test framework for the host build
+ *
+ * Every test runs in its own process, so the master and partner gamepads, and everything registered on them, start
+ * fresh in every test.
+ */
+namespace test {
+
+struct TestCase {
+        const char* name;
+        void (*body)();
+};
+
+/**
+ * @brief Get every test that has been defined with TEST()
+ */
+std::vector<TestCase>& registry();
+
+struct Register {
+        Register(const char* name, void (*body)()) { registry().push_back({name, body}); }
+};
+
+/**
+ * @brief Report a failed check, and end the test
+ *
+ * The test ends without running static destructors, like a passing test does, because tasks the test started may
+ * still be waiting on the host port.
+ */
+[[noreturn]] inline void fail(const char* file, int line, const char* check) {
+    std::fprintf(stderr, "  %s:%d: check failed: %s\n", file, line, check);
+    std::fflush(nullptr);
+    std::_Exit(1);
+}
+
+/**
+ * @brief Drives a gamepad through the host port, on the simulated clock of the host port
+ *
+ * The clock only moves between updates, and the gamepad's tasks, such as the sampler and the dispatcher, run on the
+ * same clock, so every run sees exactly the same timing.
+ */
+class Sim {
+    public:
+        /**
+         * @brief Switch the host port to simulated time, and connect the controller
+         *
+         * @param id The controller to drive
+         */
+        explicit Sim(pros::controller_id_e_t id = pros::E_CONTROLLER_MASTER)
+            : m_id(id) {
+            // start well after 0, so that nothing mistakes the first update for "never"
+            pros::host::useSimulatedTime(1000000);
+            pros::host::setConnected(m_id, true);
+        }
+
+        gamepad::Gamepad& gamepad() { return m_id == pros::E_CONTROLLER_MASTER ? gamepad::master : gamepad::partner; }
+
+        void press(pros::controller_digital_e_t button) { pros::host::setDigital(m_id, button, true); }
+
+        void release(pros::controller_digital_e_t button) { pros::host::setDigital(m_id, button, false); }
+
+        /**
+         * @brief Advance the clock, then update the gamepad, and wait for the tasks it notified
+         *
+         * @param ms How far to advance the clock, in ms
+         */
+        void step(uint32_t ms = FRAME) {
+            pros::host::advanceTime(uint64_t(ms) * 1000);
+            this->gamepad().update();
+            pros::host::waitForTasks();
+        }
+
+        /**
+         * @brief Update the gamepad once every frame for the given time
+         *
+         * @param ms How long to run for, in ms
+         */
+        void run(uint32_t ms) {
+            for (uint32_t elapsed = 0; elapsed < ms; elapsed += FRAME) this->step();
+        }
+
+        /**
+         * @brief Get the current time of the simulated clock, in µs
+         */
+        uint64_t now() const { return pros::c::micros(); }
+
+        /// The time between updates in ms, the same as a typical control loop
+        static constexpr uint32_t FRAME = 10;
+    private:
+        pros::controller_id_e_t m_id;
+};
+} // namespace test
+
+#define TEST(name)                                                                                                     \
+    static void test_##name();                                                                                         \
+    static test::Register register_##name(#name, test_##name);                                                         \
+    static void test_##name()
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) test::fail(__FILE__, __LINE__, #condition);                                                  \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                                     \
+    do {                                                                                                               \
+        const auto actual_value = (actual);                                                                            \
+        const auto expected_value = (expected);                                                                        \
+        if (!(actual_value == expected_value)) {                                                                       \
+            std::fprintf(stderr, "  got %lld, expected %lld\n", static_cast<long long>(actual_value),                  \
+                         static_cast<long long>(expected_value));                                                      \
+            test::fail(__FILE__, __LINE__, #actual " == " #expected);                                                  \
+        }                                                                                                              \
+    } while (0)
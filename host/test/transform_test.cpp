@@ -0,0 +1,45 @@
+#include "test.hpp"
+
+using namespace pros;
+
+namespace {
+uint32_t s_calls = 0;
+
+/**
+ * @brief Halves the joystick, and counts how many times it was asked to
+ */
+class CountingTransformation : public gamepad::AbstractTransformation {
+    public:
+        std::pair<float, float> get_value(std::pair<float, float> original) override {
+            s_calls++;
+            return {original.first / 2, original.second / 2};
+        }
+};
+} // namespace
+
+TEST(transform_once_per_update) {
+    test::Sim sim;
+    constexpr uint32_t UPDATES = 50;
+    sim.gamepad().set_left_transform(gamepad::TransformationBuilder(CountingTransformation()));
+    host::setAnalog(E_CONTROLLER_MASTER, E_CONTROLLER_ANALOG_LEFT_X, 127);
+    host::setAnalog(E_CONTROLLER_MASTER, E_CONTROLLER_ANALOG_RIGHT_X, 127);
+    for (uint32_t i = 0; i < UPDATES; i++) {
+        sim.step();
+        // reading the axes over and over only reads the result of the update
+        for (int read = 0; read < 20; read++) {
+            CHECK(sim.gamepad().axisLeftX() == 0.5f);
+            CHECK(sim.gamepad().axisLeftX(false) == 1.0f);
+            CHECK(sim.gamepad().axisLeftY() == 0.0f);
+            CHECK(sim.gamepad().axisRightX() == 1.0f);
+        }
+    }
+    CHECK_EQ(s_calls, UPDATES);
+    CHECK_EQ(sim.gamepad().transformEvaluations(), UPDATES);
+
+    // each joystick with a transformation is evaluated once per update
+    sim.gamepad().set_right_transform(gamepad::TransformationBuilder(CountingTransformation()));
+    sim.run(UPDATES * test::Sim::FRAME);
+    CHECK_EQ(s_calls, 3 * UPDATES);
+    CHECK_EQ(sim.gamepad().transformEvaluations(), 3 * UPDATES);
+    CHECK(sim.gamepad().axisRightX() == 0.5f);
+}
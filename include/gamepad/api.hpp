@@ -2,4 +2,5 @@
 
 #include "gamepad/event_handler.hpp" // IWYU pragma: export
 #include "gamepad/gamepad.hpp" // IWYU pragma: export
+#include "gamepad/input_log.hpp" // IWYU pragma: export
 #include "gamepad/screens/alertScreen.hpp" // IWYU pragma: export
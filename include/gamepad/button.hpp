@@ -1,11 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <string>
 
 #include "event_handler.hpp"
 
+#ifndef GAMEPAD_MAX_LISTENERS
+/// The maximum number of listeners each button event can hold, define this in the Makefile to change it
+#define GAMEPAD_MAX_LISTENERS 4
+#endif
+
 namespace gamepad {
 enum EventType {
     ON_PRESS,
@@ -14,6 +20,8 @@ enum EventType {
     ON_SHORT_RELEASE,
     ON_LONG_RELEASE,
     ON_REPEAT_PRESS,
+    ON_DOUBLE_TAP,
+    ON_MULTI_TAP,
 };
 
 class Button {
@@ -25,12 +33,20 @@ class Button {
         bool falling_edge = false;
         /// Whether the button is currently held down
         bool is_pressed = false;
-        /// How long the button has been held down
+        /// How long the button has been held down, in ms
         uint32_t time_held = 0;
-        /// How long the button has been released
+        /// How long the button has been released, in ms
         uint32_t time_released = 0;
-        /// How many times the button has been repeat-pressed
+        /// How long the button has been held down, in µs
+        uint64_t time_held_us = 0;
+        /// How long the button has been released, in µs
+        uint64_t time_released_us = 0;
+        /// How many times the button has been repeat-pressed, only counted while the button has long press or repeat
+        /// press listeners
         uint32_t repeat_iterations = 0;
+        /// How many times the button has been tapped in the current (or most recent) series of taps, only counted
+        /// while the button has double tap or multi tap listeners, or delays its press for taps
+        uint32_t tap_count = 0;
         /**
          * @brief Set the time for a press to be considered a long press for the button
          *
@@ -68,13 +84,47 @@ class Button {
          * @endcode
          */
         void setRepeatCooldown(uint32_t cooldown) const;
+        /**
+         * @brief Set the most time between two presses for them to count as taps of the same series
+         *
+         * @note this is likely to be used with the onDoubleTap() or onMultiTap() events
+         *
+         * @param window the time in ms, 200ms by default
+         *
+         * @b Example:
+         * @code {.cpp}
+         *   // allow a slower double tap
+         *   gamepad::master.buttonB().setTapWindow(300);
+         * @endcode
+         */
+        void setTapWindow(uint32_t window) const;
+        /**
+         * @brief Set whether the press event should wait until the series of taps is over
+         *
+         * When enabled, onPress listeners only run if the button was tapped once, and only once the tap window has
+         * passed without another tap. This stops a double tap from also running the onPress listeners.
+         *
+         * @note release events are not delayed, so a quick tap may fire its release events before its press event
+         *
+         * @param delay whether or not to delay the press event, false by default
+         *
+         * @b Example:
+         * @code {.cpp}
+         *   // pressing B runs the intake, double tapping B reverses it, and never both
+         *   gamepad::master.buttonB().setDelayPressForTaps(true);
+         *   gamepad::master.buttonB().onPress("intake", []() { intake.move(127); });
+         *   gamepad::master.buttonB().onDoubleTap("outtake", []() { intake.move(-127); });
+         * @endcode
+         */
+        void setDelayPressForTaps(bool delay) const;
         /**
          * @brief Register a function to run when the button is pressed.
          *
          * @param listenerName The name of the listener, this must be a unique name
          * @param func The function to run when the button is pressed, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
          *
          * @b Example:
          * @code {.cpp}
@@ -97,7 +147,8 @@ class Button {
          * @param listenerName The name of the listener, this must be a unique name
          * @param func The function to run when the button is long pressed, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
          *
          * @b Example:
          * @code {.cpp}
@@ -115,7 +166,8 @@ class Button {
          * @param listenerName The name of the listener, this must be a unique name
          * @param func The function to run when the button is released, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
          *
          * @b Example:
          * @code {.cpp}
@@ -137,7 +189,8 @@ class Button {
          * @param listenerName The name of the listener, this must be a unique name
          * @param func The function to run when the button is short released, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
          *
          * @b Example:
          * @code {.cpp}
@@ -157,7 +210,8 @@ class Button {
          * @param listenerName The name of the listener, this must be a unique name
          * @param func The function to run when the button is long released, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
          *
          * @b Example:
          * @code {.cpp}
@@ -178,7 +232,8 @@ class Button {
          * @param listenerName The name of the listener, this must be a unique name
          * @param func the function to run periodically when the button is held, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
          *
          * @b Example:
          * @code {.cpp}
@@ -190,14 +245,60 @@ class Button {
          *
          */
         int32_t onRepeatPress(std::string listenerName, std::function<void(void)> func) const;
+        /**
+         * @brief Register a function to run when the button is tapped twice in a row
+         *
+         * The second press must start within the tap window of the first one, which is 200ms by default and can be
+         * adjusted via the setTapWindow() method. The listeners run as soon as the second press starts.
+         *
+         * @param listenerName The name of the listener, this must be a unique name
+         * @param func the function to run when the button is double tapped, the function MUST NOT block
+         * @return 0 The listener was successfully registered
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
+         *
+         * @b Example:
+         * @code {.cpp}
+         *   // Use a function...
+         *   gamepad::master.B.onDoubleTap("toggleIntakeMode", toggleIntakeMode);
+         *   // ...or a lambda
+         *   gamepad::master.Y.onDoubleTap("toggleWings", []() { wings.toggle(); });
+         * @endcode
+         */
+        int32_t onDoubleTap(std::string listenerName, std::function<void(void)> func) const;
+        /**
+         * @brief Register a function to run when a series of taps is over
+         *
+         * A series of taps is over once the tap window has passed since its last press. The number of taps in the
+         * series, including single taps, is stored in tap_count.
+         *
+         * @param listenerName The name of the listener, this must be a unique name
+         * @param func the function to run when a series of taps is over, the function MUST NOT block
+         * @return 0 The listener was successfully registered
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, or to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered
+         *
+         * @b Example:
+         * @code {.cpp}
+         *   // select an autonomous route by tapping A that many times
+         *   gamepad::master.A.onMultiTap("selectAuton", []() { selectAuton(gamepad::master.buttonA().tap_count); });
+         * @endcode
+         */
+        int32_t onMultiTap(std::string listenerName, std::function<void(void)> func) const;
         /**
          * @brief Register a function to run for a given event.
          *
+         * @note registering a named listener allocates, even though running it never does: the name is stored with
+         * a "_user" suffix, which rarely fits in the inline buffer of a std::string, and std::function allocates for
+         * a callable that captures more than a couple of pointers. Use the handle overload in code that runs often.
+         *
          * @param event Which event to register the listener on.
          * @param listenerName The name of the listener, this must be a unique name
          * @param func The function to run for the given event, the function MUST NOT block
          * @return 0 The listener was successfully registered
-         * @return INT32_MAX The listener was not successfully registered (there is already a listener with this name)
+         * @return INT32_MAX The listener was not successfully registered, setting errno to EEXIST if there is already a
+         * listener with this name, to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered, or to EINVAL
+         * if the event is invalid
          *
          * @b Example:
          * @code {.cpp}
@@ -208,6 +309,29 @@ class Button {
          * @endcode
          */
         int32_t addListener(EventType event, std::string listenerName, std::function<void(void)> func) const;
+        /**
+         * @brief Register an unnamed function to run for a given event.
+         *
+         * Unlike the named overload, this does not need to build or compare any strings, and the returned handle
+         * removes the listener in constant time. The function is stored in place, so registering it never allocates,
+         * and a function too large for the listener table fails to compile. Prefer this when listeners are added and
+         * removed frequently.
+         *
+         * @param event Which event to register the listener on.
+         * @param func The function to run for the given event, the function MUST NOT block
+         * @return ListenerHandle A handle to the listener, this is not valid if the listener could not be registered,
+         * setting errno to ENOMEM if GAMEPAD_MAX_LISTENERS listeners are already registered, or to EINVAL if the event
+         * is invalid
+         *
+         * @b Example:
+         * @code {.cpp}
+         *   // register a listener while the intake mode is active...
+         *   gamepad::ListenerHandle handle = gamepad::master.buttonR1().addListener(gamepad::ON_PRESS, intakeIn);
+         *   // ...and remove it when the mode changes
+         *   gamepad::master.buttonR1().removeListener(handle);
+         * @endcode
+         */
+        ListenerHandle addListener(EventType event, _impl::InplaceFunction<void(void)> func) const;
         /**
          * @brief Removes a listener from the button
          * @warning Usage of this function is discouraged.
@@ -226,6 +350,15 @@ class Button {
          * @endcode
          */
         int32_t removeListener(EventType event, std::string listenerName) const;
+        /**
+         * @brief Removes a listener from the button using the handle returned when it was registered
+         *
+         * @param handle The handle of the listener to remove
+         * @return 0 The specified listener was successfully removed
+         * @return INT32_MAX The specified listener could not be removed (it was already removed, the handle is
+         * invalid, or the handle belongs to a listener of another button)
+         */
+        int32_t removeListener(ListenerHandle handle) const;
 
         /**
          * @brief Returns a value indicating whether the button is currently being held.
@@ -236,34 +369,85 @@ class Button {
         explicit operator bool() const { return is_pressed; }
     private:
         /**
-         * @brief Updates the button and runs any event handlers, if necessary
+         * @brief Updates the button, and works out which events happened
+         *
+         * @note this does not run any listeners, pass the result to fire() to run them
          *
          * @param is_held Whether or not the button is currently held down
+         * @param now The timestamp of the current update in µs, this is shared by every button in the update
+         * @return uint8_t A bitmask of the events that happened, where bit n is set if EventType n happened
          */
-        void update(bool is_held);
+        uint8_t update(bool is_held, uint64_t now);
+        /**
+         * @brief Updates a button that was released before the last update, and is still released. This is equivalent
+         * to update(false), but does much less work.
+         *
+         * @param now The timestamp of the current update in µs
+         * @return uint8_t A bitmask of the events that happened, where bit n is set if EventType n happened
+         */
+        uint8_t updateReleased(uint64_t now);
+        /**
+         * @brief Ends the current series of taps if the tap window has passed since its last press
+         *
+         * @param now The timestamp of the current update in µs
+         * @return uint8_t A bitmask of the events that happened, where bit n is set if EventType n happened
+         */
+        uint8_t endTaps(uint64_t now);
+        /**
+         * @brief Runs the listeners of each event in a bitmask returned by update(), in EventType order
+         *
+         * @param events A bitmask of events, where bit n is set if EventType n should be fired
+         */
+        void fire(uint8_t events) const;
         /**
          * @brief Get the handler object for the given event type
          *
          * @param event The desired event type
          * @return nullptr The event value is invalid
-         * @return _impl::EventHandler<std::string>* A pointer to the given event's handler
+         * @return _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS>* A pointer to the given event's handler
+         */
+        _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS>* get_handler(EventType event) const;
+        /**
+         * @brief Updates the interest mask after listeners for the given event type were added or removed
+         *
+         * @param event The event type whose listeners changed
          */
-        _impl::EventHandler<std::string>* get_handler(EventType event) const;
+        void updateInterest(EventType event) const;
         /// How long the threshold should be for the longPress and shortRelease events
         mutable uint32_t m_long_press_threshold = 500;
         /// How often repeatPress is called
         mutable uint32_t m_repeat_cooldown = 50;
-        /// The last time the update function was called
-        uint32_t m_last_update_time = pros::millis();
-        /// The last time the long press event was fired
-        uint32_t m_last_long_press_time = 0;
-        /// The last time the repeat event was called
-        uint32_t m_last_repeat_time = 0;
-        mutable _impl::EventHandler<std::string> m_on_press_event {};
-        mutable _impl::EventHandler<std::string> m_on_long_press_event {};
-        mutable _impl::EventHandler<std::string> m_on_release_event {};
-        mutable _impl::EventHandler<std::string> m_on_short_release_event {};
-        mutable _impl::EventHandler<std::string> m_on_long_release_event {};
-        mutable _impl::EventHandler<std::string> m_on_repeat_press_event {};
+        /// The last time the update function was called, in µs
+        uint64_t m_last_update_time = 0;
+        /// The last time the long press event was fired, in µs
+        uint64_t m_last_long_press_time = 0;
+        /// The last time the repeat event was called, in µs
+        uint64_t m_last_repeat_time = 0;
+        /// How long to hold back the press event in ms, so that a chord can claim the press first
+        std::atomic<uint32_t> m_press_delay = 0;
+        /// Whether the press event is being held back
+        bool m_press_pending = false;
+        /// Whether a chord has claimed this button's events until it is released
+        bool m_suppressed = false;
+        /// The most time in ms between two presses for them to be taps of the same series
+        mutable uint32_t m_tap_window = 200;
+        /// Whether the press event waits until the series of taps is over
+        mutable bool m_delay_press_for_taps = false;
+        /// When the last tap started, in µs
+        uint64_t m_last_tap_time = 0;
+        /// Whether a series of taps is in progress
+        bool m_taps_pending = false;
+        /// Whether the press event of the first tap is waiting for the series of taps to end
+        bool m_tap_press_pending = false;
+        /// A bitmask of the event types that have listeners, where bit n is set if EventType n has any
+        mutable std::atomic<uint8_t> m_interest = 0;
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_press_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_long_press_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_release_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_short_release_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_long_release_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_repeat_press_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_double_tap_event {};
+        mutable _impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS> m_on_multi_tap_event {};
 };
 } // namespace gamepad
\ No newline at end of file
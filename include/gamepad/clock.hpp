@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "pros/rtos.h"
+
+namespace gamepad {
+
+/**
+ * @brief Where the library reads the time from
+ *
+ * Every Gamepad::update() reads the time once, and every button, chord, sequence and screen times itself from that
+ * reading, so replacing the clock replaces the time everywhere.
+ */
+class Clock {
+    public:
+        /**
+         * @brief Get the current time in µs
+         */
+        virtual uint64_t micros() const = 0;
+        virtual ~Clock() = default;
+};
+
+/**
+ * @brief The time since PROS started, this is the clock the library uses unless it is replaced
+ */
+class SystemClock final : public Clock {
+    public:
+        uint64_t micros() const override { return pros::c::micros(); }
+};
+
+/**
+ * @brief A clock that only moves when it is told to, so hours of input can be simulated in seconds
+ *
+ * @b Example:
+ * @code {.cpp}
+ * static gamepad::SimulatedClock clock;
+ * gamepad::setClock(&clock);
+ * // hold A for a whole minute, without waiting a minute
+ * for (int i = 0; i < 6000; i++) {
+ *   clock.advance(10000);
+ *   gamepad::master.update();
+ * }
+ * @endcode
+ */
+class SimulatedClock final : public Clock {
+    public:
+        /**
+         * @brief Construct a new SimulatedClock
+         *
+         * @param start The time to start at, in µs
+         */
+        constexpr SimulatedClock(uint64_t start = 0)
+            : m_now(start) {}
+
+        uint64_t micros() const override { return m_now.load(); }
+
+        /**
+         * @brief Move the clock forward
+         *
+         * @param micros How far to move the clock, in µs
+         */
+        void advance(uint64_t micros) { m_now += micros; }
+
+        /**
+         * @brief Set the time of the clock
+         *
+         * @note if the clock is moved backwards, each gamepad continues from the time of its last update
+         *
+         * @param micros The new time, in µs
+         */
+        void set(uint64_t micros) { m_now = micros; }
+    private:
+        std::atomic<uint64_t> m_now;
+};
+
+namespace _impl {
+/// The clock the library reads the time from, or nullptr for the system clock
+inline constinit std::atomic<const Clock*> s_clock = nullptr;
+
+/**
+ * @brief Get the current time in µs, from the clock set by setClock()
+ */
+inline uint64_t micros() {
+    const Clock* clock = s_clock.load();
+    // the system clock is read directly, so the common case doesn't cost a virtual call
+    return clock == nullptr ? pros::c::micros() : clock->micros();
+}
+} // namespace _impl
+
+/**
+ * @brief Replace the clock the library reads the time from
+ *
+ * @note the sampling, dispatcher and flush tasks still sleep on the system clock
+ * @note if the new clock is behind the old one, each gamepad continues from the time of its last update, so nothing
+ * that is being timed sees time go backwards
+ *
+ * @param clock The new clock, or nullptr to go back to the system clock. The clock must stay alive until it is
+ * replaced, so it is easiest to make it static.
+ */
+inline void setClock(const Clock* clock) { _impl::s_clock = clock; }
+} // namespace gamepad
@@ -1,23 +1,87 @@
 #pragma once
 
 #include <mutex>
-#include <functional>
-#include <vector>
-#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
 
+#include "gamepad/inplace_function.hpp"
 #include "gamepad/recursive_mutex.hpp"
 
-namespace gamepad::_impl {
+namespace gamepad {
+
+/**
+ * @brief A generation-counted reference to a registered listener
+ *
+ * A handle stays cheap to store and compare, and removing a listener through its handle takes constant time. Once the
+ * listener is removed the slot's generation changes, so stale handles are rejected instead of removing a listener
+ * that later reused the same slot. A handle also remembers the handler that issued it, so it can not remove a
+ * listener from any other handler.
+ */
+struct ListenerHandle {
+        /// The handler that issued the handle
+        const void* owner = nullptr;
+        /// Identifies which event of the owner the handle belongs to, Button stores the EventType here
+        uint8_t tag = UINT8_MAX;
+        /// The index of the slot the listener occupies
+        uint8_t slot = UINT8_MAX;
+        /// The generation of the slot when the listener was registered
+        uint16_t generation = 0;
+
+        /**
+         * @brief Whether or not the handle was returned by a successful registration
+         *
+         * @note a valid handle may still refer to a listener that has since been removed
+         */
+        constexpr bool isValid() const { return slot != UINT8_MAX; }
+
+        constexpr bool operator==(const ListenerHandle&) const = default;
+};
+
+namespace _impl {
 
 /**
  * @brief Event handling class with thread safety that supports adding, removing, and running listeners
  *
+ * Listeners are stored inline in a fixed-size table of slots, so no memory is allocated after the handler is
+ * constructed and running the listeners never copies them. Listeners are run in slot order.
+ *
+ * Firing does not take the mutex. Instead, every change to the listeners publishes a new bitmask of the occupied
+ * slots, and fire() walks the bitmask it loaded when it started. A listener is never moved while it is published, and
+ * a removed listener is only destroyed once no fire() that could still be running it is in progress. Until then its
+ * slot is retired, and cannot be reused. This means listeners can block, or add and remove listeners, without
+ * stalling other tasks that fire or modify the same handler.
+ *
+ * @note retired slots are only reclaimed once no fire() is in progress at all, that is once the number of readers
+ * drops to zero, not once the fire() that could be running the removed listener returns. If fire() calls from several
+ * tasks keep overlapping, the retired slots pile up, and a handler that is close to full may reject new listeners
+ * until the fires stop overlapping.
+ *
  * @tparam Key the key type for (un)registering listener (this type MUST support operator== and operator!=)
+ * @tparam Capacity the maximum number of listeners that can be registered at once (at most 64)
  * @tparam Args the types of the parameters that each listener is passed
  */
-template <typename Key, typename... Args> class EventHandler {
+template <typename Key, std::size_t Capacity, typename... Args> class EventHandler {
+        static_assert(Capacity > 0 && Capacity <= 64, "EventHandler supports between 1 and 64 listeners");
     public:
-        using Listener = std::function<void(Args...)>;
+        using Listener = InplaceFunction<void(Args...)>;
+
+        /**
+         * @brief Add an unnamed listener to the list of listeners
+         *
+         * @param func The function to run when this event is fired
+         * @return ListenerHandle a handle to the new listener, this is not valid if the handler is full, setting errno
+         * to ENOMEM
+         */
+        ListenerHandle addListener(Listener func) {
+            std::lock_guard lock(m_mutex);
+            return this->insert(std::move(func));
+        }
 
         /**
          * @brief Add a listener to the list of listeners
@@ -25,13 +89,34 @@ template <typename Key, typename... Args> class EventHandler {
          * @param key The listener key (this must be a unique key value)
          * @param func The function to run when this event is fired
          * @return 0 The listener was successfully added
-         * @return INT32_MAX The listener was NOT successfully added (there is already a listener with the same key)
+         * @return INT32_MAX The listener was NOT successfully added, setting errno to EEXIST if there is already a
+         * listener with the same key, or to ENOMEM if the handler is full
          */
         int32_t addListener(Key key, Listener func) {
             std::lock_guard lock(m_mutex);
-            if (std::find(m_keys.begin(), m_keys.end(), key) != m_keys.end()) return INT32_MAX;
-            m_keys.push_back(key);
-            m_listeners.push_back(func);
+            if (this->find(key) != Capacity) {
+                errno = EEXIST;
+                return INT32_MAX;
+            }
+            ListenerHandle handle = this->insert(std::move(func));
+            if (!handle.isValid()) return INT32_MAX;
+            m_slots[handle.slot].key = std::move(key);
+            m_named |= bit(handle.slot);
+            return 0;
+        }
+
+        /**
+         * @brief Remove a listener using the handle returned when it was added
+         *
+         * @param handle The handle of the listener
+         * @return 0 The listener was successfully removed
+         * @return INT32_MAX The listener was NOT successfully removed (the handle is stale, invalid, or was issued by
+         * another handler)
+         */
+        int32_t removeListener(ListenerHandle handle) {
+            std::lock_guard lock(m_mutex);
+            if (!this->contains(handle)) return INT32_MAX;
+            this->erase(handle.slot);
             return 0;
         }
 
@@ -44,13 +129,23 @@ template <typename Key, typename... Args> class EventHandler {
          */
         int32_t removeListener(Key key) {
             std::lock_guard lock(m_mutex);
-            auto i = std::find(m_keys.begin(), m_keys.end(), key);
-            if (i != m_keys.end()) {
-                m_keys.erase(i);
-                m_listeners.erase(m_listeners.begin() + (i - m_keys.begin()));
-                return 0;
-            }
-            return INT32_MAX;
+            std::size_t slot = this->find(key);
+            if (slot == Capacity) return INT32_MAX;
+            this->erase(slot);
+            return 0;
+        }
+
+        /**
+         * @brief Whether or not the listener referred to by the handle is still registered
+         *
+         * @param handle The handle of the listener
+         * @return true The listener is registered
+         * @return false The listener was removed, the handle is invalid, or the handle was issued by another handler
+         */
+        bool contains(ListenerHandle handle) {
+            std::lock_guard lock(m_mutex);
+            return handle.owner == this && handle.slot < Capacity && (m_active & bit(handle.slot)) &&
+                   m_slots[handle.slot].generation == handle.generation;
         }
 
         /**
@@ -59,10 +154,7 @@ template <typename Key, typename... Args> class EventHandler {
          * @return true There are listeners registered
          * @return false There are no listeners registered
          */
-        bool isEmpty() {
-            std::lock_guard lock(m_mutex);
-            return m_listeners.empty();
-        }
+        bool isEmpty() const { return m_published.load() == 0; }
 
         /**
          * @brief Runs each listener registered
@@ -70,12 +162,128 @@ template <typename Key, typename... Args> class EventHandler {
          * @param args The parameters to pass to each listener
          */
         void fire(Args... args) {
-            std::lock_guard lock(m_mutex);
-            for (auto listener : m_listeners) { listener(args...); }
+            ReadGuard guard(*this);
+            for (uint64_t published = m_published.load(); published != 0; published &= published - 1) {
+                m_slots[std::countr_zero(published)].listener(args...);
+            }
+        }
+        /**
+         * @brief Runs the listeners registered in the given slots
+         *
+         * @param slots A bitmask of the slots to run, where bit i is the slot in the handles with a slot of i
+         * @param args The parameters to pass to each listener
+         */
+        void fireSlots(uint64_t slots, Args... args) {
+            ReadGuard guard(*this);
+            for (uint64_t published = m_published.load() & slots; published != 0; published &= published - 1) {
+                m_slots[std::countr_zero(published)].listener(args...);
+            }
         }
     private:
-        std::vector<Key> m_keys {};
-        std::vector<Listener> m_listeners {};
+        struct Slot {
+                /// The key of a named listener, this is empty until a key is assigned so that empty slots can be
+                /// constant-initialized
+                std::optional<Key> key {};
+                Listener listener {};
+                uint16_t generation = 0;
+        };
+
+        /**
+         * @brief Marks a fire() as in progress for as long as it exists, and frees retired slots once the last
+         * fire() in progress finishes
+         */
+        class ReadGuard {
+            public:
+                ReadGuard(EventHandler& handler)
+                    : m_handler(handler) {
+                    m_handler.m_readers.fetch_add(1);
+                }
+
+                ~ReadGuard() {
+                    if (m_handler.m_readers.fetch_sub(1) == 1 && m_handler.m_retired.load() != 0 &&
+                        m_handler.m_mutex.try_lock()) {
+                        m_handler.reclaim();
+                        m_handler.m_mutex.unlock();
+                    }
+                }
+            private:
+                EventHandler& m_handler;
+        };
+
+        static constexpr uint64_t bit(std::size_t slot) { return uint64_t(1) << slot; }
+
+        /**
+         * @brief Destroy the listeners in retired slots if no fire() is in progress, the mutex must be held
+         */
+        void reclaim() {
+            uint64_t retired = m_retired.load();
+            if (retired == 0 || m_readers.load() != 0) return;
+            for (; retired != 0; retired &= retired - 1) m_slots[std::countr_zero(retired)].listener.reset();
+            m_retired.store(0);
+        }
+
+        /**
+         * @brief Place a listener in the first free slot, the mutex must be held
+         *
+         * @param func The function to run when this event is fired
+         * @return ListenerHandle a handle to the new listener, this is not valid if the handler is full, setting errno
+         * to ENOMEM
+         */
+        ListenerHandle insert(Listener func) {
+            this->reclaim();
+            std::size_t slot = std::countr_one(m_active | m_retired.load());
+            if (slot >= Capacity) {
+                errno = ENOMEM;
+                return {};
+            }
+            m_slots[slot].listener = std::move(func);
+            m_active |= bit(slot);
+            m_published.store(m_active);
+            return {.owner = this, .slot = static_cast<uint8_t>(slot), .generation = m_slots[slot].generation};
+        }
+
+        /**
+         * @brief Unpublish a slot and invalidate any handles to it, the mutex must be held
+         *
+         * @param slot The index of the slot
+         */
+        void erase(std::size_t slot) {
+            m_slots[slot].key = std::nullopt;
+            m_slots[slot].generation++;
+            m_active &= ~bit(slot);
+            m_named &= ~bit(slot);
+            m_published.store(m_active);
+            // a fire() that loaded the old bitmask may still be running this listener
+            m_retired.store(m_retired.load() | bit(slot));
+            this->reclaim();
+        }
+
+        /**
+         * @brief Find the slot of the named listener with the given key, the mutex must be held
+         *
+         * @param key The listener key
+         * @return std::size_t The index of the slot, or Capacity if there is no such listener
+         */
+        std::size_t find(const Key& key) const {
+            for (uint64_t named = m_named; named != 0; named &= named - 1) {
+                std::size_t slot = std::countr_zero(named);
+                if (m_slots[slot].key == key) return slot;
+            }
+            return Capacity;
+        }
+
+        std::array<Slot, Capacity> m_slots {};
+        /// A bitmask of the slots that hold a listener
+        uint64_t m_active = 0;
+        /// The bitmask of occupied slots that fire() reads, this always matches m_active outside of the mutex
+        std::atomic<uint64_t> m_published = 0;
+        /// A bitmask of the slots whose listener was removed, but may still be running
+        std::atomic<uint64_t> m_retired = 0;
+        /// The number of fire() calls in progress
+        std::atomic<uint32_t> m_readers = 0;
+        /// A bitmask of the slots that hold a listener registered with a key
+        uint64_t m_named = 0;
         gamepad::_impl::RecursiveMutex m_mutex {};
 };
-} // namespace gamepad::_impl
+} // namespace _impl
+} // namespace gamepad
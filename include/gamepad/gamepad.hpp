@@ -2,15 +2,39 @@
 
 #include "joystick_transformation.hpp"
 #include "pros/misc.h"
+#include "pros/rtos.h"
 #include "screens/defaultScreen.hpp"
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include "screens/abstractScreen.hpp"
+#include "screens/lineScheduler.hpp"
 #include "button.hpp"
+#include "clock.hpp"
+#include "input_history.hpp"
+#include "input_source.hpp"
+#include "input_snapshot.hpp"
+#include "seqlock.hpp"
+#include "sequence_recognizer.hpp"
+#include "spsc_queue.hpp"
+#include "update_profile.hpp"
 #include "pros/misc.hpp"
 
+#ifndef GAMEPAD_EVENT_QUEUE_SIZE
+/// The number of button events the dispatcher queue can hold, define this in the Makefile to change it
+#define GAMEPAD_EVENT_QUEUE_SIZE 64
+#endif
+
+#ifndef GAMEPAD_HISTORY_SIZE
+/// The number of updates each gamepad keeps in its input history, define this in the Makefile to change it
+#define GAMEPAD_HISTORY_SIZE 128
+#endif
+
 namespace gamepad {
 class Gamepad {
     public:
@@ -31,6 +55,22 @@ class Gamepad {
          *
          */
         void update();
+        /**
+         * @brief Create the resources of the gamepad that are not needed until it is used, such as its default screen
+         *
+         * The master and partner gamepads are constant-initialized, so they do no work before initialize() runs.
+         * Their resources are created the first time they are needed instead, or by calling this function to create
+         * them at a predictable time. Calling it again does nothing.
+         *
+         * @b Example:
+         * @code {.cpp}
+         * void initialize() {
+         *   // allocate everything now, instead of during the first update
+         *   gamepad::master.init();
+         * }
+         * @endcode
+         */
+        void init();
         /**
          * @brief Add a screen to the screen update loop that can update the controller's screen
          *
@@ -44,6 +84,216 @@ class Gamepad {
          * gamepad::master.add_screen(alerts);
          */
         void addScreen(std::shared_ptr<AbstractScreen> screen);
+        /**
+         * @brief Run button listeners on a dedicated dispatcher task, instead of inside update()
+         *
+         * Once the dispatcher is started, update() only records which button events happened in a bounded queue, and
+         * the dispatcher task runs the listeners. A slow listener then no longer delays sampling the remaining buttons,
+         * the joysticks, or the screen. If the queue is full, events are dropped and counted by droppedEvents().
+         *
+         * @note Listeners run shortly after the update() that detected their event, so fields such as
+         * Button::repeat_iterations may have changed by the time a listener reads them.
+         * @warning update() must only be called from one task once the dispatcher is started.
+         *
+         * @param priority The priority of the dispatcher task
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EEXIST: The dispatcher has already been started
+         * ENOMEM: The dispatcher task could not be created
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // run listeners at a lower priority than the control loop
+         * gamepad::master.startDispatcher(TASK_PRIORITY_DEFAULT - 1);
+         * @endcode
+         *
+         * @return 0 if the dispatcher was started successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t startDispatcher(uint32_t priority = TASK_PRIORITY_DEFAULT);
+        /**
+         * @brief Get the number of button events that were dropped because the dispatcher queue was full
+         *
+         * @note if this is not 0, the dispatcher task may need a higher priority, or GAMEPAD_EVENT_QUEUE_SIZE may need
+         * to be increased
+         */
+        uint32_t droppedEvents() const;
+        /**
+         * @brief Get the most button events that have been waiting in the dispatcher queue at once
+         */
+        uint32_t maxQueuedEvents() const;
+        /**
+         * @brief Get the longest time in µs that a button event has waited in the dispatcher queue before its
+         * listeners were run
+         */
+        uint32_t maxDispatchLatency() const;
+        /**
+         * @brief Get the number of button events that were skipped because the event type had no listeners
+         *
+         * Each skipped event is a handler that did not have to be fired. The count only goes up, so sampling it
+         * once a second gives the number of fires saved per second.
+         */
+        uint32_t skippedEvents() const;
+        /**
+         * @brief Sample the buttons on a dedicated task at a fixed rate, instead of only inside update()
+         *
+         * The sampling task records every press and release it sees until the next update(), so the accuracy of edge
+         * detection no longer depends on how often update() is called. update() still has to be called to apply the
+         * recorded presses and releases and run listeners, but a press that starts and ends between two calls is no
+         * longer missed: it is applied as a press immediately followed by a release.
+         *
+         * @note only one press and release of each button is kept between two calls to update()
+         *
+         * @param period How often to sample the buttons, in ms
+         * @param priority The priority of the sampling task
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EEXIST: The sampling task has already been started
+         * ENOMEM: The sampling task could not be created
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // catch quick taps even though the control loop only runs every 20ms
+         * gamepad::master.startSampling(5, TASK_PRIORITY_DEFAULT + 1);
+         * @endcode
+         *
+         * @return 0 if the sampling task was started successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t startSampling(uint32_t period = 5, uint32_t priority = TASK_PRIORITY_DEFAULT);
+        /**
+         * @brief Read input from the given source instead of the controller
+         *
+         * Every update() then reads one frame from the source, and uses its timestamp as the time of the update, so
+         * button events, transformations, and listeners behave exactly as they did when the frames were recorded.
+         * The timestamps are shifted to continue from the last update, so switching to a recording made earlier does
+         * not turn time back for the buttons, chords, sequences and screens that are already timing something.
+         *
+         * @note the sampling task is not used while an input source is set
+         *
+         * @param source The source to read from, or nullptr to read from the controller again
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // replay a recorded match as fast as possible
+         * auto replay = std::make_shared<gamepad::ReplaySource>(recorder->frames());
+         * gamepad::master.setInputSource(replay);
+         * while (!replay->finished()) gamepad::master.update();
+         * @endcode
+         */
+        void setInputSource(std::shared_ptr<InputSource> source);
+        /**
+         * @brief Pass every frame of input that update() reads to the given sink, such as an InputRecorder
+         *
+         * @param sink The sink to pass frames to, or nullptr to stop
+         */
+        void setInputSink(std::shared_ptr<InputSink> sink);
+        /**
+         * @brief Register a function to run when a combination of buttons is pressed together
+         *
+         * A chord is pressed when every one of its buttons is held, and all of them were pressed within the
+         * simultaneity window of each other. The listeners run during the update() where the last button of the chord
+         * goes down, and will not run again until one of the buttons is released and pressed again.
+         *
+         * If suppress is true, the buttons of the chord do not fire their own events for a press that completes the
+         * chord. To make this possible, their press events are held back by up to the window, so that a chord can
+         * claim them first. Pressing a button on its own still fires its events, just up to the window later.
+         *
+         * @note the window and suppress options are shared by every listener of the same chord, and the most recent
+         * registration sets them
+         * @note chord listeners always run inside update(), even if the dispatcher has been started
+         *
+         * @param listenerName The name of the listener, this must be a unique name for the chord
+         * @param buttons The buttons that make up the chord, there must be at least 2
+         * @param func The function to run when the chord is pressed, the function MUST NOT block
+         * @param window The most time in ms between the first and last button of the chord being pressed
+         * @param suppress Whether or not pressing the chord should stop its buttons from firing their own events
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EINVAL: There are less than 2 buttons, or one of the buttons is not valid
+         *
+         * EEXIST: There is already a listener with this name for the chord
+         *
+         * ENOMEM: GAMEPAD_MAX_LISTENERS listeners are already registered for the chord
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // L1 + R1 toggles the wings, without also running the L1 and R1 listeners
+         * gamepad::master.onChord("toggleWings", {DIGITAL_L1, DIGITAL_R1}, toggleWings, 100, true);
+         * @endcode
+         *
+         * @return 0 The listener was successfully registered
+         * @return INT32_MAX The listener was not successfully registered, setting errno
+         */
+        int32_t onChord(std::string listenerName, std::vector<pros::controller_digital_e_t> buttons,
+                        std::function<void(void)> func, uint32_t window = 100, bool suppress = false);
+        /**
+         * @brief Removes a listener from a chord
+         *
+         * @param listenerName The name of the listener to remove
+         * @param buttons The buttons that make up the chord
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EINVAL: There are less than 2 buttons, or one of the buttons is not valid
+         *
+         * @return 0 The specified listener was successfully removed
+         * @return INT32_MAX The specified listener could not be removed, or there was an error, setting errno
+         */
+        int32_t removeChord(std::string listenerName, std::vector<pros::controller_digital_e_t> buttons);
+        /**
+         * @brief Register a function to run when a sequence of buttons is pressed, one after another
+         *
+         * Each button of the sequence must be pressed within the sequence timeout of the previous one, which is 300ms
+         * by default. All sequences are compiled into one shared automaton, so recognizing them costs the same no
+         * matter how many are registered.
+         *
+         * @note listeners run inside update(), after the button listeners, even if the dispatcher has been started
+         * @note once a sequence is recognized, recognition starts over, so its presses can not also complete the end
+         * of another sequence
+         *
+         * @param listenerName The name of the listener, this must be a unique name
+         * @param buttons The buttons of the sequence, in the order they must be pressed
+         * @param func The function to run when the sequence is pressed, the function MUST NOT block
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EINVAL: The sequence is empty, or one of the buttons is not valid
+         *
+         * EEXIST: There is already a sequence listener with this name
+         *
+         * ENOMEM: GAMEPAD_MAX_SEQUENCES sequence listeners are already registered
+         *
+         * E2BIG: The sequences registered, together with this one, are more than 65534 presses long
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // run the hang macro when up, up, down, A is pressed
+         * gamepad::master.onSequence("hang", {DIGITAL_UP, DIGITAL_UP, DIGITAL_DOWN, DIGITAL_A}, startHang);
+         * @endcode
+         *
+         * @return 0 The listener was successfully registered
+         * @return INT32_MAX The listener was not successfully registered, setting errno
+         */
+        int32_t onSequence(std::string listenerName, std::vector<pros::controller_digital_e_t> buttons,
+                           std::function<void(void)> func);
+        /**
+         * @brief Removes a sequence listener
+         *
+         * @param listenerName The name of the listener to remove
+         * @return 0 The specified listener was successfully removed
+         * @return INT32_MAX The specified listener could not be removed
+         */
+        int32_t removeSequence(std::string listenerName);
+        /**
+         * @brief Set the most time that can pass between two presses of a sequence
+         *
+         * @param timeout The timeout in ms, 300ms by default
+         */
+        void setSequenceTimeout(uint32_t timeout);
         /**
          * @brief print a line to the console like pros (low priority)
          *
@@ -64,7 +314,7 @@ class Gamepad {
          * @return 0 if the line was printed successfully
          * @return INT32_MAX if there was an error, setting errno
          */
-        int32_t printLine(uint8_t line, std::string str);
+        int32_t printLine(uint8_t line, std::string_view str);
         /**
          * @brief clears all lines on the controller, similar to the pros function (low priority)
          *
@@ -114,7 +364,50 @@ class Gamepad {
          * @return 0 if the rumble was successful
          * @return INT32_MAX if there was an error, setting errno
          */
-        void rumble(std::string rumble_pattern);
+        void rumble(std::string_view rumble_pattern);
+        /**
+         * @brief Set the most time a line should wait before it is sent to the controller
+         *
+         * The controller only accepts a write about every 50ms. When several lines are waiting, the one that has
+         * waited longest is sent first, and lines from higher priority screens count as having waited longer: every
+         * doubling of the priority of a screen counts as one more write. A line that would miss its deadline by
+         * waiting for one more write is sent before every line that would not.
+         *
+         * @param line the line (0-2), or 3 for the rumble pattern
+         * @param deadline the deadline in ms, or 0 for no deadline (the default)
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EINVAL: The line number is not in the interval [0, 3]
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // the battery readout on the top line should never be more than 100ms behind
+         * gamepad::master.setLineDeadline(0, 100);
+         * @endcode
+         *
+         * @return 0 if the deadline was set successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t setLineDeadline(uint8_t line, uint32_t deadline);
+        /**
+         * @brief Get how long the lines sent to a line of the controller took to show up
+         *
+         * @note the statistics are written by update(), so they should be read from the task that calls update()
+         *
+         * @param line the line (0-2), or 3 for the rumble pattern
+         *
+         * @b Example:
+         * @code {.cpp}
+         * gamepad::LineStats stats = gamepad::master.lineStats(0);
+         * if (stats.writes != 0) {
+         *   printf("line 0: %lu ms average, %lu ms worst\n", uint32_t(stats.total / stats.writes), stats.max);
+         * }
+         * @endcode
+         *
+         * @return the statistics of the line, which are all 0 if the line is not in the interval [0, 3]
+         */
+        LineStats lineStats(uint8_t line) const;
         /**
          * @brief Get the state of a button on the controller.
          *
@@ -142,6 +435,32 @@ class Gamepad {
          *
          */
         float operator[](pros::controller_analog_e_t joystick);
+        /**
+         * @brief Get a copy of the state of every button and joystick, as of the latest update
+         *
+         * Unlike the Button fields, which are written while update() runs, this never sees a half updated state, so
+         * it is safe to call from any task. It never blocks.
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // read the controller from another task
+         * gamepad::InputSnapshot input = gamepad::master.snapshot();
+         * if (input.isPressed(DIGITAL_R1)) intake.move(input.axes[ANALOG_RIGHT_Y] * 127);
+         * @endcode
+         */
+        InputSnapshot snapshot() const;
+        /**
+         * @brief Get the record of the last GAMEPAD_HISTORY_SIZE updates
+         *
+         * @note this should only be used from the task that calls update(), or from listeners that it runs
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // where was the left joystick 100ms ago?
+         * float old_y = gamepad::master.history().axisAt(ANALOG_LEFT_Y, gamepad::master.snapshot().timestamp - 100000);
+         * @endcode
+         */
+        const InputHistory<GAMEPAD_HISTORY_SIZE>& history() const;
 
         /// The L1 button on the top of the controller.
         const Button& buttonL1();
@@ -224,18 +543,88 @@ class Gamepad {
          * @param right_transformation The transformation to be used
          */
         void set_right_transform(Transformation right_transformation);
+        /**
+         * @brief Get the number of times a joystick transformation has been evaluated
+         *
+         * Each transformation is evaluated once per update(), and the results are cached until the next one, so this
+         * goes up by at most 2 per update no matter how many times the axes are read.
+         */
+        uint32_t transformEvaluations() const;
+        /**
+         * @brief Get the time update() has spent in each of its phases since the last call to resetProfile()
+         *
+         * @note update() is only timed when GAMEPAD_PROFILE is set to 1 in the Makefile, otherwise every time is 0
+         * @note the profile is written by update(), so it should be read from the task that calls update()
+         *
+         * @b Example:
+         * @code {.cpp}
+         * gamepad::UpdateProfile profile = gamepad::master.profile();
+         * printf("screens: %llu ns/update\n", profile.ns[gamepad::PHASE_SCREENS] / profile.updates);
+         * @endcode
+         */
+        UpdateProfile profile() const;
+        /**
+         * @brief Reset the time update() has spent in each of its phases to 0
+         */
+        void resetProfile();
 
         /// The master controller, same as @ref gamepad::master
         static Gamepad master;
         /// The partner controller, same as @ref gamepad::partner
         static Gamepad partner;
     private:
-        Gamepad(pros::controller_id_e_t id);
+        constexpr Gamepad(pros::controller_id_e_t id)
+            : m_id(id) {}
 
         Button m_L1 {}, m_L2 {}, m_R1 {}, m_R2 {}, m_Up {}, m_Down {}, m_Left {}, m_Right {}, m_X {}, m_B {}, m_Y {},
             m_A {};
-        float m_LeftX = 0, m_LeftY = 0, m_RightX = 0, m_RightY = 0;
         Button Fake {};
+        /// The number of buttons on the controller
+        static constexpr uint8_t BUTTON_COUNT = 12;
+        /// Every button, indexed from 0 for L1 to 11 for A, so bit n of the button bitmasks belongs to BUTTONS[n]
+        static constexpr std::array<Button Gamepad::*, BUTTON_COUNT> BUTTONS = {
+            &Gamepad::m_L1,   &Gamepad::m_L2,    &Gamepad::m_R1, &Gamepad::m_R2, &Gamepad::m_Up, &Gamepad::m_Down,
+            &Gamepad::m_Left, &Gamepad::m_Right, &Gamepad::m_X,  &Gamepad::m_B,  &Gamepad::m_Y,  &Gamepad::m_A,
+        };
+        /// A bitmask of the buttons that are held down
+        uint16_t m_button_state = 0;
+        /// A bitmask of the buttons that were pressed during the last update
+        uint16_t m_rising_edges = 0;
+        /// A bitmask of the buttons that were released during the last update
+        uint16_t m_falling_edges = 0;
+        /// When each button was last pressed in µs, indexed like BUTTONS
+        std::array<uint64_t, BUTTON_COUNT> m_press_times {};
+
+        /// A combination of buttons, and the listeners to run when they are pressed together
+        struct Chord {
+                /// The bitmask of the buttons in the chord
+                uint16_t mask;
+                /// The most time in ms between the first and last button of the chord being pressed
+                uint32_t window;
+                /// Whether or not the chord claims the events of its buttons
+                bool suppress;
+                std::shared_ptr<_impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS>> handler;
+        };
+
+        /// Every chord that has at least one listener, sorted by mask. Handlers are shared, so update() can fire them
+        /// after releasing the lock even if the chord is removed in the meantime.
+        std::vector<Chord> m_chords {};
+        /// A bitmask of every button that is part of a chord
+        std::atomic<uint16_t> m_chord_buttons = 0;
+        _impl::RecursiveMutex m_chord_mutex {};
+        _impl::SequenceRecognizer m_sequences {};
+        /**
+         * @brief Find where the chord with the given mask is, or would be inserted, in m_chords. The chord mutex must
+         * be held.
+         *
+         * @param mask The bitmask of the buttons in the chord
+         */
+        std::vector<Chord>::iterator findChord(uint16_t mask);
+        /**
+         * @brief Recompute which buttons are part of a chord, and how long each button holds back its press events.
+         * The chord mutex must be held.
+         */
+        void updateChordButtons();
         std::optional<Transformation> m_left_transformation {std::nullopt};
         std::optional<Transformation> m_right_transformation {std::nullopt};
         /**
@@ -248,28 +637,183 @@ class Gamepad {
          */
         static std::string uniqueName();
         static Button Gamepad::* buttonToPtr(pros::controller_digital_e_t button);
-        void updateButton(pros::controller_digital_e_t button_id);
+        /**
+         * @brief Reads whether each button is held from the controller
+         *
+         * @return uint16_t A bitmask of the buttons that are held down
+         */
+        uint16_t readButtons() const;
+        /**
+         * @brief Reads the next frame of input from the input source, or from the controller and the sampling task if
+         * there is none, and passes it to the input sink
+         *
+         * @param frame where to store the frame
+         * @return true A frame was read
+         * @return false The input source has no more input
+         */
+        bool readFrame(InputFrame& frame);
+        /**
+         * @brief Updates the buttons with the state in a frame of input
+         *
+         * @param frame The frame of the current update
+         */
+        void updateButtons(const InputFrame& frame);
+        /**
+         * @brief Finds the rising and falling edges of all buttons at once, and only runs the per-button timing logic
+         * for buttons that are held or changed recently
+         *
+         * @param state A bitmask of the buttons that are held down
+         * @param now The timestamp of the current update in µs
+         */
+        void applyButtons(uint16_t state, uint64_t now);
+        /**
+         * @brief Samples the buttons forever, recording every edge. This is the body of the sampling task.
+         */
+        void sampleButtons();
+        /**
+         * @brief Updates a single button, and runs or queues the listeners of any events that happened
+         *
+         * @param index The index of the button, from 0 for L1 to 11 for A
+         * @param is_held Whether or not the button is currently held down
+         * @param now The timestamp of the current update in µs
+         */
+        void updateButton(uint8_t index, bool is_held, uint64_t now);
+        /**
+         * @brief Runs the listeners of the given events of a button, or queues them for the dispatcher task
+         *
+         * @param index The index of the button, from 0 for L1 to 11 for A
+         * @param events The events that happened, as a bitmask of EventType
+         * @param now The timestamp of the current update in µs
+         */
+        void dispatch(uint8_t index, uint8_t events, uint64_t now);
+        /**
+         * @brief Passes the events every button fired during the current update to the input sink, if there is one
+         *
+         * @param now The timestamp of the current update in µs
+         */
+        void recordEvents(uint64_t now);
+        /**
+         * @brief Records when buttons were pressed, and runs the listeners of every chord completed this update
+         *
+         * @note this must run before the buttons are updated, so that suppressing chords can claim their events
+         *
+         * @param now The timestamp of the current update in µs
+         */
+        void updateChords(uint64_t now);
+        /**
+         * @brief Converts a list of buttons into a chord bitmask
+         *
+         * @param buttons The buttons that make up the chord
+         * @return uint16_t The bitmask of the buttons, or 0 if the list is not a valid chord
+         */
+        static uint16_t chordMask(const std::vector<pros::controller_digital_e_t>& buttons);
+        /**
+         * @brief Runs the listeners of the events in the dispatcher queue, forever. This is the body of the
+         * dispatcher task.
+         */
+        void dispatchEvents();
 
-        void updateScreens();
+        /// A button event waiting in the dispatcher queue
+        struct EventRecord {
+                /// The time in µs when the event happened, truncated to 32 bits
+                uint32_t timestamp;
+                /// The index of the button, from 0 for L1 to 11 for A
+                uint8_t button;
+                /// The EventType of the event
+                uint8_t event;
+        };
 
-        std::shared_ptr<DefaultScreen> m_default_screen = std::make_shared<DefaultScreen>();
+        /**
+         * @brief Updates every screen, and prints the next line that needs printing to the controller
+         *
+         * @param now The timestamp of the current update in µs
+         * @param connected Whether or not the controller is connected
+         */
+        void updateScreens(uint64_t now, bool connected);
+        /**
+         * @brief Applies the joystick transformations to the axes of a snapshot, and stores the results in its
+         * transformed axes
+         *
+         * @param snapshot The snapshot of the current update
+         */
+        void transformAxes(InputSnapshot& snapshot);
+
+        /**
+         * @brief Get the default screen, creating it if this is the first time it is needed
+         */
+        DefaultScreen& defaultScreen();
+
+        /// The default screen, this is created by init()
+        std::shared_ptr<DefaultScreen> m_default_screen = nullptr;
         std::vector<std::shared_ptr<AbstractScreen>> m_screens = {};
         ScreenBuffer m_current_screen = {};
         ScreenBuffer m_next_buffer = {};
-        pros::Controller m_controller;
+        _impl::LineScheduler m_line_scheduler {};
+        pros::controller_id_e_t m_id;
 
         uint8_t m_last_printed_line = 0;
+        /// The last time a line was printed to the controller, in ms
         uint32_t m_last_print_time = 0;
+        /// The last time the screens were updated, in ms, or 0 before the first update
         uint32_t m_last_update_time = 0;
         bool m_screen_cleared = false;
-        pros::Mutex m_mutex {};
+        _impl::RecursiveMutex m_mutex {};
+
+        std::atomic<pros::task_t> m_dispatch_task = nullptr;
+        _impl::SpscQueue<EventRecord, GAMEPAD_EVENT_QUEUE_SIZE> m_event_queue {};
+        std::atomic<uint32_t> m_dropped_events = 0;
+        std::atomic<uint32_t> m_max_queued_events = 0;
+        std::atomic<uint32_t> m_max_dispatch_latency = 0;
+        std::atomic<uint32_t> m_skipped_events = 0;
+
+        std::atomic<pros::task_t> m_sampling_task = nullptr;
+        /// How often the sampling task samples the buttons, in ms
+        uint32_t m_sample_period = 5;
+        /// The latest sample of the buttons in bits 0-15, and the rising and falling edges recorded since the last
+        /// update in bits 16-31 and 32-47, all indexed like BUTTONS
+        std::atomic<uint64_t> m_sample = 0;
+
+        /// The number of updates so far
+        uint32_t m_frame = 0;
+        /// The state of the controller as of the latest update, the axis accessors read from this
+        _impl::Seqlock<InputSnapshot> m_snapshot {};
+        std::atomic<uint32_t> m_transform_evaluations = 0;
+        UpdateProfile m_profile {};
+        InputHistory<GAMEPAD_HISTORY_SIZE> m_history {};
+        /// Where update() reads its input from, or nullptr for the controller
+        std::shared_ptr<InputSource> m_source = nullptr;
+        /// What is added to the timestamp of each frame, so that time never goes backwards between updates
+        std::atomic<uint64_t> m_time_offset = 0;
+        /// The timestamp of the last update after the offset was added, in µs, or 0 if there has not been one
+        uint64_t m_last_time = 0;
+        /// Whether the next frame comes from a different source than the last one
+        bool m_source_changed = false;
+        /// Where update() passes the input it reads, or nullptr for nowhere
+        std::shared_ptr<InputSink> m_sink = nullptr;
+        /// The events each button fired during the current update, indexed like BUTTONS
+        std::array<uint8_t, BUTTON_COUNT> m_fired_events {};
+        /// A bitmask of the buttons that fired events during the current update, indexed like BUTTONS
+        uint16_t m_fired_buttons = 0;
 };
 
-inline Gamepad Gamepad::master {pros::E_CONTROLLER_MASTER};
-inline Gamepad Gamepad::partner {pros::E_CONTROLLER_PARTNER};
+constinit inline Gamepad Gamepad::master {pros::E_CONTROLLER_MASTER};
+constinit inline Gamepad Gamepad::partner {pros::E_CONTROLLER_PARTNER};
 /// The master controller
 inline Gamepad& master = Gamepad::master;
 /// The partner controller
 inline Gamepad& partner = Gamepad::partner;
 
+/**
+ * @brief Get the number of kernel mutexes that the library currently uses
+ *
+ * Each kernel mutex is a FreeRTOS queue allocated on the kernel heap. They are only created the first time they are
+ * locked, such as when a listener is registered, so this is 0 at startup.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * printf("gamepad is using %lu kernel mutexes\n", gamepad::kernelMutexCount());
+ * @endcode
+ */
+inline uint32_t kernelMutexCount() { return _impl::RecursiveMutex::count(); }
+
 } // namespace gamepad
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace gamepad::_impl {
+
+/// The default amount of inline storage for an InplaceFunction, large enough to hold a std::function on any target
+inline constexpr std::size_t INPLACE_FUNCTION_STORAGE = sizeof(std::function<void()>) + sizeof(void*);
+
+template <typename Signature, std::size_t Size = INPLACE_FUNCTION_STORAGE> class InplaceFunction;
+
+/**
+ * @brief A move-only callable wrapper that stores its target inline, and never allocates
+ *
+ * Unlike std::function, the callable is always stored in a fixed-size buffer inside the object. Callables that do not
+ * fit in the buffer are rejected at compile time instead of silently falling back to the heap.
+ *
+ * @tparam R the return type of the callable
+ * @tparam Args the types of the parameters that the callable is passed
+ * @tparam Size the number of bytes of inline storage
+ */
+template <typename R, typename... Args, std::size_t Size> class InplaceFunction<R(Args...), Size> {
+    public:
+        constexpr InplaceFunction() = default;
+
+        /**
+         * @brief Construct a new InplaceFunction holding the given callable
+         *
+         * @param func the callable to store, it must fit in the inline storage
+         */
+        template <typename F>
+            requires(!std::same_as<std::remove_cvref_t<F>, InplaceFunction> &&
+                     std::invocable<std::decay_t<F>&, Args...>)
+        InplaceFunction(F&& func) {
+            using T = std::decay_t<F>;
+            static_assert(sizeof(T) <= Size, "callable is too large for the inline storage of this InplaceFunction");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "callable is over-aligned");
+            ::new (static_cast<void*>(m_storage)) T(std::forward<F>(func));
+            m_ops = &OPS<T>;
+        }
+
+        InplaceFunction(InplaceFunction&& other) noexcept { this->take(std::move(other)); }
+
+        InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+            if (this != &other) {
+                this->reset();
+                this->take(std::move(other));
+            }
+            return *this;
+        }
+
+        InplaceFunction(const InplaceFunction&) = delete;
+        InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+        constexpr ~InplaceFunction() { this->reset(); }
+
+        /**
+         * @brief Invoke the stored callable
+         *
+         * @param args the parameters to pass to the callable
+         * @return R the value returned by the callable
+         */
+        R operator()(Args... args) { return m_ops->invoke(m_storage, std::forward<Args>(args)...); }
+
+        /**
+         * @brief Destroy the stored callable, leaving this InplaceFunction empty
+         */
+        constexpr void reset() {
+            if (m_ops != nullptr) m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+
+        /**
+         * @brief Whether or not a callable is stored
+         *
+         * @return true a callable is stored
+         * @return false this InplaceFunction is empty
+         */
+        explicit operator bool() const { return m_ops != nullptr; }
+    private:
+        struct Ops {
+                R (*invoke)(void*, Args&&...);
+                void (*move)(void*, void*);
+                void (*destroy)(void*);
+        };
+
+        template <typename T> static constexpr Ops OPS {
+            [](void* storage, Args&&... args) -> R {
+                return std::invoke(*static_cast<T*>(storage), std::forward<Args>(args)...);
+            },
+            [](void* dest, void* src) { ::new (dest) T(std::move(*static_cast<T*>(src))); },
+            [](void* storage) { static_cast<T*>(storage)->~T(); },
+        };
+
+        void take(InplaceFunction&& other) {
+            if (other.m_ops == nullptr) return;
+            other.m_ops->move(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+            other.reset();
+        }
+
+        alignas(std::max_align_t) std::byte m_storage[Size] {};
+        const Ops* m_ops = nullptr;
+};
+} // namespace gamepad::_impl
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include "pros/misc.h"
+
+namespace gamepad {
+
+/**
+ * @brief A fixed-size record of the last N updates of a controller, with queries over time
+ *
+ * All storage is allocated inline, so recording an update never allocates. Every query is O(log N) or better: frames
+ * are found by binary search on their timestamps, and averages are computed from running sums stored with each frame.
+ *
+ * @note the history is written by Gamepad::update(), so it should only be queried from the task that calls update(),
+ * or from listeners that it runs
+ *
+ * @tparam N the number of updates to keep (must be a power of 2)
+ */
+template <std::size_t N> class InputHistory {
+        static_assert(std::has_single_bit(N), "InputHistory size must be a power of 2");
+    public:
+        /**
+         * @brief Record an update, replacing the oldest one if the history is full
+         *
+         * @param timestamp The timestamp of the update in µs, this must not be older than the previous update
+         * @param buttons A bitmask of the buttons that are held down, where bit n is E_CONTROLLER_DIGITAL_L1 + n
+         * @param rising_edges A bitmask of the buttons that were pressed during the update
+         * @param axes The raw value of each joystick axis between -127 and 127, indexed by pros::controller_analog_e_t
+         */
+        void push(uint64_t timestamp, uint16_t buttons, uint16_t rising_edges, std::array<int8_t, 4> axes) {
+            Frame& frame = m_frames[m_count % N];
+            const Frame& previous = m_frames[(m_count - 1) % N];
+            for (; rising_edges != 0; rising_edges &= rising_edges - 1) {
+                m_last_press[std::countr_zero(rising_edges)] = timestamp;
+            }
+            for (std::size_t i = 0; i < axes.size(); i++) {
+                // the sums are allowed to wrap around, the difference between two of them is still correct
+                frame.axis_sums[i] = (m_count == 0 ? 0 : previous.axis_sums[i]) + static_cast<uint32_t>(axes[i]);
+            }
+            frame.timestamp = timestamp;
+            frame.buttons = buttons;
+            frame.axes = axes;
+            m_count++;
+        }
+
+        /**
+         * @brief Get the number of updates in the history
+         */
+        std::size_t size() const { return m_count < N ? m_count : N; }
+
+        /**
+         * @brief Whether or not the button was pressed within the given time of the latest update
+         *
+         * @param button The button to check
+         * @param within The time in ms
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // buffer a shot if A was pressed just before the catapult finished reloading
+         * if (catapult.isReady() && gamepad::master.history().wasPressed(DIGITAL_A, 150)) catapult.fire();
+         * @endcode
+         */
+        bool wasPressed(pros::controller_digital_e_t button, uint32_t within) const {
+            if (m_count == 0 || button < pros::E_CONTROLLER_DIGITAL_L1 || button > pros::E_CONTROLLER_DIGITAL_A) {
+                return false;
+            }
+            uint64_t pressed = m_last_press[button - pros::E_CONTROLLER_DIGITAL_L1];
+            return pressed != 0 && this->latest().timestamp - pressed <= uint64_t(within) * 1000;
+        }
+
+        /**
+         * @brief Whether or not the button was held down at the given time
+         *
+         * @param button The button to check
+         * @param time The timestamp in µs, if this is older than the history the oldest update is used
+         */
+        bool isPressedAt(pros::controller_digital_e_t button, uint64_t time) const {
+            if (m_count == 0 || button < pros::E_CONTROLLER_DIGITAL_L1 || button > pros::E_CONTROLLER_DIGITAL_A) {
+                return false;
+            }
+            return this->at(time).buttons & (1 << (button - pros::E_CONTROLLER_DIGITAL_L1));
+        }
+
+        /**
+         * @brief Get the value of a joystick axis at the given time
+         *
+         * @param axis The joystick axis
+         * @param time The timestamp in µs, if this is older than the history the oldest update is used
+         * @return float The value of the axis between -1.0 and 1.0, without any transformation
+         */
+        float axisAt(pros::controller_analog_e_t axis, uint64_t time) const {
+            if (m_count == 0 || axis > pros::E_CONTROLLER_ANALOG_RIGHT_Y) return 0;
+            return this->at(time).axes[axis] / 127.0;
+        }
+
+        /**
+         * @brief Get the average value of a joystick axis over the updates within the given time of the latest update
+         *
+         * @param axis The joystick axis
+         * @param over The time in ms
+         * @return float The average value of the axis between -1.0 and 1.0, without any transformation
+         *
+         * @b Example:
+         * @code {.cpp}
+         * // smooth out the left joystick
+         * drive.arcade(gamepad::master.history().axisAverage(ANALOG_LEFT_Y, 50), gamepad::master.axisRightX());
+         * @endcode
+         */
+        float axisAverage(pros::controller_analog_e_t axis, uint32_t over) const {
+            if (m_count == 0 || axis > pros::E_CONTROLLER_ANALOG_RIGHT_Y) return 0;
+            const Frame& latest = this->latest();
+            uint64_t start = latest.timestamp > uint64_t(over) * 1000 ? latest.timestamp - uint64_t(over) * 1000 : 0;
+            std::size_t first = this->find(start);
+            // find() gives the last update at or before the start, so skip it unless it is exactly at the start
+            if (first + 1 < this->size() && this->frame(first).timestamp < start) first++;
+            const Frame& oldest = this->frame(first);
+            int32_t sum = static_cast<int32_t>(latest.axis_sums[axis] - oldest.axis_sums[axis]) + oldest.axes[axis];
+            return sum / 127.0f / (this->size() - first);
+        }
+    private:
+        struct Frame {
+                uint64_t timestamp = 0;
+                /// The running sum of each axis up to and including this update
+                std::array<uint32_t, 4> axis_sums {};
+                uint16_t buttons = 0;
+                std::array<int8_t, 4> axes {};
+        };
+
+        /**
+         * @brief Get an update by its index, from 0 for the oldest
+         */
+        const Frame& frame(std::size_t index) const { return m_frames[(m_count - this->size() + index) % N]; }
+
+        const Frame& latest() const { return m_frames[(m_count - 1) % N]; }
+
+        /**
+         * @brief Find the index of the last update at or before the given time, or the oldest update if there is none
+         *
+         * @param time The timestamp in µs
+         */
+        std::size_t find(uint64_t time) const {
+            std::size_t low = 0, high = this->size();
+            // the answer is always in [low, high), so the search ends on the last update at or before the time
+            while (high - low > 1) {
+                std::size_t middle = low + (high - low) / 2;
+                if (this->frame(middle).timestamp <= time) low = middle;
+                else high = middle;
+            }
+            return low;
+        }
+
+        const Frame& at(uint64_t time) const { return this->frame(this->find(time)); }
+
+        std::array<Frame, N> m_frames {};
+        /// The number of updates ever recorded
+        uint32_t m_count = 0;
+        /// When each button was last pressed in µs, indexed from 0 for L1 to 11 for A
+        std::array<uint64_t, 12> m_last_press {};
+};
+} // namespace gamepad
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "gamepad/input_source.hpp"
+#include "pros/rtos.h"
+
+namespace gamepad {
+
+/**
+ * @brief The events a button fired during one update, as stored in an input log
+ */
+struct LoggedEvents {
+        /// The timestamp of the frame that fired the events, in µs
+        uint64_t timestamp = 0;
+        pros::controller_digital_e_t button = pros::E_CONTROLLER_DIGITAL_L1;
+        /// A bitmask of the events that happened, where bit n is set if EventType n happened
+        uint8_t events = 0;
+};
+
+/**
+ * @brief Writes frames of input, and the events they fired, to a compact binary log file
+ *
+ * Each frame only stores what changed since the previous one: a tag byte, the time since the previous frame as a
+ * varint, the changed buttons, and zigzag varint deltas of the changed axes. A full keyframe is written once every
+ * keyframe interval, and closing the log appends an index of the keyframes, so InputLogReader can seek to any time
+ * in O(log n). At 100 updates per second, a frame that does not change anything takes 3 bytes. The events a button
+ * fires are stored right after the frame that fired them, in 4 bytes.
+ *
+ * Records are encoded into one of two preallocated buffers, and the keyframe index is preallocated too, so recording
+ * never blocks and never allocates. Once a buffer is full, it is handed to the flush task
+ * to be written to the file in one large write while the other buffer fills up. If both buffers are full, records
+ * are dropped and counted by droppedFrames() and droppedEvents(), and the next frame is written as a keyframe.
+ *
+ * @warning record(), recordEvents(), flush() and close() are not synchronized with each other, so they must be called
+ * from the same task. Gamepad::update() calls the first two when the writer is its input sink.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * auto log = std::make_shared<gamepad::InputLogWriter>();
+ * log->open("/usd/match.gpil");
+ * log->startFlushing();
+ * gamepad::master.setInputSink(log);
+ * @endcode
+ */
+class InputLogWriter : public InputSink {
+    public:
+        /**
+         * @brief Construct a new InputLogWriter
+         *
+         * @param keyframe_interval The time between keyframes in ms
+         * @param capacity The size of each of the two buffers records are encoded into, in bytes
+         * @param max_keyframes The most keyframes the index holds, 12 bytes each. Keyframes after this many are still
+         * written, but not indexed, so seeking past the last indexed one decodes every frame after it. The default
+         * covers over an hour at the default interval.
+         */
+        InputLogWriter(uint32_t keyframe_interval = 1000, std::size_t capacity = 4096,
+                       std::size_t max_keyframes = 4096);
+        InputLogWriter(const InputLogWriter&) = delete;
+        InputLogWriter& operator=(const InputLogWriter&) = delete;
+        ~InputLogWriter() override;
+
+        /**
+         * @brief Create the log file and write its header
+         *
+         * @param path The path of the file, such as "/usd/match.gpil" on the brain or a path in any directory on a
+         * host
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EEXIST: A log file is already open
+         * EIO: The file could not be created or written
+         *
+         * @return 0 if the file was opened successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t open(const char* path);
+        /**
+         * @brief Write full buffers to the log file on a dedicated task, instead of only inside flush()
+         *
+         * The task sleeps until a buffer fills up, so it can run at the lowest priority without delaying the control
+         * loop. The task ends when the log is closed.
+         *
+         * @param priority The priority of the flush task
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EBADF: No log file is open
+         * EEXIST: The flush task has already been started
+         * ENOMEM: The flush task could not be created
+         *
+         * @return 0 if the flush task was started successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t startFlushing(uint32_t priority = TASK_PRIORITY_MIN);
+        void record(const InputFrame& frame) override;
+        void recordEvents(uint64_t timestamp, pros::controller_digital_e_t button, uint8_t events) override;
+        /**
+         * @brief Write the buffered records to the log file
+         *
+         * If the flush task is running, the buffer is only handed to it, so this never blocks. Otherwise, the records
+         * are written before this returns.
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EBADF: No log file is open
+         * EIO: The file could not be written
+         *
+         * @return 0 if the records were written (or handed to the flush task) successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t flush();
+        /**
+         * @brief Stop the flush task, write the buffered records and the keyframe index to the log file, and close it
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EBADF: No log file is open
+         * EIO: The file could not be written, now or by the flush task
+         *
+         * @return 0 if the file was closed successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t close();
+        /**
+         * @brief Get the number of encoded bytes that have not been written to the file yet
+         */
+        std::size_t bufferedBytes() const;
+        /**
+         * @brief Get the number of frames that were dropped because both buffers were full
+         */
+        uint32_t droppedFrames() const;
+        /**
+         * @brief Get the number of events that were dropped because both buffers were full, or their frame was dropped
+         */
+        uint32_t droppedEvents() const;
+    private:
+        struct IndexEntry {
+                uint64_t timestamp;
+                uint32_t offset;
+        };
+
+        /**
+         * @brief Encode a frame into the active buffer, which must have room for it
+         *
+         * @param frame The frame to encode
+         * @param keyframe Whether to write every field, instead of only the changes since the previous frame
+         */
+        void encode(const InputFrame& frame, bool keyframe);
+        /**
+         * @brief Make sure the active buffer has room for another record, handing it to the flush task if it doesn't
+         *
+         * @return true There is room for another record
+         * @return false Both buffers are full
+         */
+        bool reserve();
+        /**
+         * @brief Hand the active buffer to be written, and switch to the other one
+         *
+         * @return true The active buffer is empty now
+         * @return false The other buffer is still waiting to be written
+         */
+        bool handOff();
+        /**
+         * @brief Write the buffer that was handed off, if there is one
+         *
+         * @return true The buffer was written successfully, or there was none
+         * @return false The file could not be written
+         */
+        bool writeFull();
+        /**
+         * @brief Writes buffers as they are handed off, until the log is closed. This is the body of the flush task.
+         */
+        void flushBuffers();
+
+        std::FILE* m_file = nullptr;
+        std::array<std::vector<uint8_t>, 2> m_buffers {};
+        /// The buffer records are encoded into
+        uint8_t m_active = 0;
+        /// The buffer waiting to be written to the file, or -1 if there is none
+        std::atomic<int8_t> m_full = -1;
+        std::size_t m_capacity;
+        /// The number of bytes encoded since the file was opened, which is where the next record will be in the file
+        uint32_t m_offset = 0;
+        /// The number of bytes written to the file
+        std::atomic<uint32_t> m_written = 0;
+        uint64_t m_keyframe_interval;
+        uint64_t m_next_keyframe = 0;
+        bool m_need_keyframe = true;
+        InputFrame m_previous {};
+        std::vector<IndexEntry> m_index {};
+        std::atomic<pros::task_t> m_flush_task = nullptr;
+        std::atomic<bool> m_flush_task_done = false;
+        std::atomic<bool> m_closing = false;
+        /// The task that is waiting in close() for the flush task to finish
+        std::atomic<pros::task_t> m_closing_task = nullptr;
+        std::atomic<bool> m_write_failed = false;
+        std::atomic<uint32_t> m_dropped_frames = 0;
+        std::atomic<uint32_t> m_dropped_events = 0;
+};
+
+/**
+ * @brief Reads a log file written by InputLogWriter, frame by frame or from any time
+ *
+ * On a Linux host the file is memory-mapped, elsewhere it is read into memory. A reader is also an InputSource, so a
+ * log can be replayed through Gamepad::setInputSource() directly.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * auto log = std::make_shared<gamepad::InputLogReader>();
+ * log->open("/usd/match.gpil");
+ * // replay the last 30 seconds of the match
+ * log->seek(log->endTime() - 30000000);
+ * gamepad::master.setInputSource(log);
+ * @endcode
+ */
+class InputLogReader : public InputSource {
+    public:
+        InputLogReader() = default;
+        InputLogReader(const InputLogReader&) = delete;
+        InputLogReader& operator=(const InputLogReader&) = delete;
+        ~InputLogReader() override;
+
+        /**
+         * @brief Open a log file
+         *
+         * @param path The path of the file
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EEXIST: A log file is already open
+         * EIO: The file could not be read
+         * EINVAL: The file is not an input log
+         *
+         * @return 0 if the file was opened successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t open(const char* path);
+        /**
+         * @brief Read the next frame
+         *
+         * @param frame where to store the frame
+         * @return true A frame was read
+         * @return false There are no more frames
+         */
+        bool read(InputFrame& frame) override;
+        /**
+         * @brief Get the events that were fired by the frame returned by the last call to read()
+         */
+        const std::vector<LoggedEvents>& events() const;
+        /**
+         * @brief Move to the first frame at or after the given time, so it is the next one read
+         *
+         * If the log was closed properly and has a keyframe index, the keyframe before the time is found by binary
+         * search, and only the frames after it are decoded. Otherwise the log is decoded from the start.
+         *
+         * @param timestamp The time in µs
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EBADF: No log file is open
+         *
+         * @return 0 if the reader moved successfully
+         * @return INT32_MAX if there was an error, setting errno
+         */
+        int32_t seek(uint64_t timestamp);
+        /**
+         * @brief Get the time of the first frame in µs
+         */
+        uint64_t startTime() const;
+        /**
+         * @brief Get the time of the last frame in µs
+         */
+        uint64_t endTime() const;
+    private:
+        /**
+         * @brief Decode the frame at the current position, relative to the previous frame, along with the events it
+         * fired
+         *
+         * @param frame where to store the frame
+         * @return true A frame was decoded
+         * @return false There are no more frames, or the log is truncated
+         */
+        bool decode(InputFrame& frame);
+        /**
+         * @brief Read the keyframe index from the end of the file, if there is one
+         */
+        void readIndex();
+        /**
+         * @brief Get the entry of the keyframe index at the given position, a timestamp followed by an offset
+         */
+        const uint8_t* indexEntry(std::size_t i) const;
+
+        const uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+        /// Where the frames end, which is where the index starts if there is one
+        std::size_t m_end = 0;
+        std::size_t m_position = 0;
+        bool m_mapped = false;
+        std::vector<uint8_t> m_contents {};
+        /// The time of the last frame in µs, found when the log is opened
+        uint64_t m_end_time = 0;
+        /// Where the keyframe index is in the file, each entry is a timestamp followed by an offset
+        std::size_t m_index = 0;
+        uint32_t m_index_count = 0;
+        InputFrame m_previous {};
+        /// A frame that was decoded by seek(), and is returned by the next read()
+        bool m_has_pending = false;
+        InputFrame m_pending {};
+        /// The events fired by the last frame that was decoded
+        std::vector<LoggedEvents> m_events {};
+};
+} // namespace gamepad
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "pros/misc.h"
+
+namespace gamepad {
+
+/**
+ * @brief The state of every button and joystick of a controller, as of one update
+ *
+ * Snapshots are plain values, so they can be copied, stored, and passed between tasks freely.
+ */
+struct InputSnapshot {
+        /// The timestamp of the update, in µs
+        uint64_t timestamp = 0;
+        /// How many updates happened before this one
+        uint32_t frame = 0;
+        /// A bitmask of the buttons that are held down, where bit n belongs to E_CONTROLLER_DIGITAL_L1 + n
+        uint16_t buttons = 0;
+        /// A bitmask of the buttons that were pressed during the update
+        uint16_t rising_edges = 0;
+        /// A bitmask of the buttons that were released during the update
+        uint16_t falling_edges = 0;
+        /// The value of each joystick axis between -1.0 and 1.0, indexed by pros::controller_analog_e_t
+        std::array<float, 4> axes {};
+        /// The value of each joystick axis after its joystick's transformation was applied, or the same as axes if the
+        /// joystick has no transformation
+        std::array<float, 4> transformed_axes {};
+
+        /**
+         * @brief Whether or not the given button is held down
+         *
+         * @param button the button to check
+         */
+        constexpr bool isPressed(pros::controller_digital_e_t button) const { return buttons & bit(button); }
+
+        /**
+         * @brief Whether or not the given button was pressed during the update
+         *
+         * @param button the button to check
+         */
+        constexpr bool risingEdge(pros::controller_digital_e_t button) const { return rising_edges & bit(button); }
+
+        /**
+         * @brief Whether or not the given button was released during the update
+         *
+         * @param button the button to check
+         */
+        constexpr bool fallingEdge(pros::controller_digital_e_t button) const { return falling_edges & bit(button); }
+    private:
+        static constexpr uint16_t bit(pros::controller_digital_e_t button) {
+            if (button < pros::E_CONTROLLER_DIGITAL_L1 || button > pros::E_CONTROLLER_DIGITAL_A) return 0;
+            return 1 << (button - pros::E_CONTROLLER_DIGITAL_L1);
+        }
+};
+} // namespace gamepad
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pros/misc.h"
+
+namespace gamepad {
+
+/**
+ * @brief Everything Gamepad::update() reads from a controller during one update
+ */
+struct InputFrame {
+        /// When the frame was read, in µs
+        uint64_t timestamp = 0;
+        /// A bitmask of the buttons that are held down, where bit n belongs to E_CONTROLLER_DIGITAL_L1 + n
+        uint16_t buttons = 0;
+        /// A bitmask of the buttons that were pressed and released (or released and pressed) since the previous frame,
+        /// and so ended up back where they started
+        uint16_t toggled = 0;
+        /// The raw value of each joystick axis between -127 and 127, indexed by pros::controller_analog_e_t
+        std::array<int8_t, 4> axes {};
+        /// Whether or not the controller is connected
+        bool connected = true;
+};
+
+/**
+ * @brief Somewhere Gamepad::update() can read its input from, instead of the controller
+ */
+class InputSource {
+    public:
+        /**
+         * @brief Read the next frame of input
+         *
+         * @param frame where to store the frame
+         * @return true A frame was read
+         * @return false There is no more input, update() does nothing until there is
+         */
+        virtual bool read(InputFrame& frame) = 0;
+        virtual ~InputSource() = default;
+};
+
+/**
+ * @brief Something that receives every frame of input Gamepad::update() reads
+ */
+class InputSink {
+    public:
+        /**
+         * @brief Receive a frame of input, this is called from update() so it MUST NOT block
+         *
+         * @param frame the frame that was read
+         */
+        virtual void record(const InputFrame& frame) = 0;
+        /**
+         * @brief Receive the events a button fired during the update of the last frame, this is called from update()
+         * after every button has been updated, so it MUST NOT block either
+         *
+         * @param timestamp the timestamp of the frame that fired the events, in µs
+         * @param button the button that fired the events
+         * @param events A bitmask of the events that happened, where bit n is set if EventType n happened
+         */
+        virtual void recordEvents(uint64_t timestamp, pros::controller_digital_e_t button, uint8_t events) {}
+        virtual ~InputSink() = default;
+};
+
+/**
+ * @brief Records frames of input in memory, up to a fixed number of frames
+ *
+ * @b Example:
+ * @code {.cpp}
+ * // record a whole match, at one frame every 10ms
+ * auto recorder = std::make_shared<gamepad::InputRecorder>(11000);
+ * gamepad::master.setInputSink(recorder);
+ * @endcode
+ */
+class InputRecorder : public InputSink {
+    public:
+        /**
+         * @brief Construct a new InputRecorder, allocating room for every frame up front
+         *
+         * @param capacity The most frames to record, any frames after this many are dropped
+         */
+        InputRecorder(std::size_t capacity);
+        void record(const InputFrame& frame) override;
+        /**
+         * @brief Get every frame that has been recorded, oldest first
+         */
+        const std::vector<InputFrame>& frames() const;
+        /**
+         * @brief Get the number of frames that were dropped because the recorder was full
+         */
+        uint32_t droppedFrames() const;
+    private:
+        std::vector<InputFrame> m_frames {};
+        uint32_t m_dropped_frames = 0;
+};
+
+/**
+ * @brief Plays back recorded frames of input, so update() behaves exactly as it did when they were recorded
+ *
+ * The timestamps of the frames are used as the time of each update, so every event fires at the same point in the
+ * recording no matter how fast the frames are played back.
+ *
+ * @b Example:
+ * @code {.cpp}
+ * gamepad::master.setInputSource(std::make_shared<gamepad::ReplaySource>(recorder->frames()));
+ * @endcode
+ */
+class ReplaySource : public InputSource {
+    public:
+        /**
+         * @brief Construct a new ReplaySource
+         *
+         * @param frames The frames to play back, oldest first
+         */
+        ReplaySource(std::vector<InputFrame> frames);
+        bool read(InputFrame& frame) override;
+        /**
+         * @brief Whether or not every frame has been played back
+         */
+        bool finished() const;
+    private:
+        std::vector<InputFrame> m_frames;
+        std::size_t m_next = 0;
+};
+} // namespace gamepad
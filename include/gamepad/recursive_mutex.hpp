@@ -2,30 +2,46 @@
 
 #include "pros/apix.h"
 #include "pros/rtos.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
 
 namespace gamepad::_impl {
 
+/**
+ * @brief A recursive mutex whose kernel object is only created the first time it is locked
+ *
+ * Every listener table owns a mutex, and most of them are never locked, so creating the kernel objects lazily keeps
+ * them off the kernel heap, and out of static initialization.
+ */
 class RecursiveMutex {
     public:
         /**
-         * @brief Construct a new recursive mutex
+         * @brief Construct a new recursive mutex, without creating its kernel object yet
          *
          */
-        RecursiveMutex()
-            : mutex(pros::c::mutex_recursive_create()) {}
+        constexpr RecursiveMutex() = default;
+
+        RecursiveMutex(const RecursiveMutex&) = delete;
+        RecursiveMutex& operator=(const RecursiveMutex&) = delete;
 
         /**
          * @brief Locks the recursive mutex, optionally bailing out after a timeout
          *
          * @param timeout How long to wait for the mutex before baling out
          * @return true The mutex was successfully acquired
-         * @return false The mutex was not successfully acquired
+         * @return false The mutex was not successfully acquired, setting errno to ENOMEM if its kernel object could
+         * not be created
          */
-        bool take(std::uint32_t timeout = TIMEOUT_MAX) { return pros::c::mutex_recursive_take(mutex, timeout); }
+        bool take(std::uint32_t timeout = TIMEOUT_MAX) {
+            pros::mutex_t current = this->get();
+            return current != nullptr && pros::c::mutex_recursive_take(current, timeout);
+        }
 
         /**
          * @brief Locks the mutex, waiting indefinitely until the mutex is acquired
          *
+         * @note if the kernel mutex can not be created, creating it is tried again until it succeeds
          */
         void lock() {
             while (!this->take()) pros::delay(2);
@@ -45,7 +61,10 @@ class RecursiveMutex {
          * @return true The mutex was successfully released
          * @return false The mutex was not successfully released
          */
-        bool give() { return pros::c::mutex_recursive_give(mutex); }
+        bool give() {
+            pros::mutex_t current = mutex.load();
+            return current != nullptr && pros::c::mutex_recursive_give(current);
+        }
 
         /**
          * @brief Unlocks the mutex, equivalent to \ref give()
@@ -56,9 +75,42 @@ class RecursiveMutex {
         /**
          * @brief Destroy the recursive mutex and free any allocated memory
          */
-        ~RecursiveMutex() { pros::c::mutex_delete(mutex); }
+        ~RecursiveMutex() {
+            if (mutex.load() == nullptr) return;
+            pros::c::mutex_delete(mutex.load());
+            s_count--;
+        }
+
+        /**
+         * @brief Get the number of kernel mutexes that currently exist for RecursiveMutex objects
+         */
+        static uint32_t count() { return s_count.load(); }
     private:
-        pros::mutex_t mutex;
+        /**
+         * @brief Get the kernel mutex, creating it if this is the first time it is needed
+         *
+         * @return pros::mutex_t The kernel mutex, or nullptr if it could not be created, setting errno to ENOMEM
+         */
+        pros::mutex_t get() {
+            pros::mutex_t current = mutex.load();
+            if (current != nullptr) return current;
+            pros::mutex_t created = pros::c::mutex_recursive_create();
+            // the next lock tries to create it again
+            if (created == nullptr) {
+                errno = ENOMEM;
+                return nullptr;
+            }
+            // another task may have created the kernel mutex first, in which case that one is used instead
+            if (!mutex.compare_exchange_strong(current, created)) {
+                pros::c::mutex_delete(created);
+                return current;
+            }
+            s_count++;
+            return created;
+        }
+
+        std::atomic<pros::mutex_t> mutex = nullptr;
+        static inline std::atomic<uint32_t> s_count = 0;
 };
 
 } // namespace gamepad::_impl
\ No newline at end of file
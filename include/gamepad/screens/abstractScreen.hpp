@@ -1,19 +1,121 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <optional>
-#include <set>
-#include <string>
+#include <string_view>
 #include "pros/misc.h"
 
 namespace gamepad {
 
+/// The number of characters that fit on one line of the controller screen
+constexpr std::size_t SCREEN_WIDTH = 19;
+
 /**
- * @brief type for conveying a full screen with the first 3 being the lines
- * of text on the controller screen and the last being a rumble pattern
+ * @brief One line of text on the controller screen, or a rumble pattern
+ *
+ * The characters are stored inline, so a line never allocates. Text that is wider than the screen is cut off.
  */
-typedef std::array<std::optional<std::string>, 4> ScreenBuffer;
+class ScreenLine {
+    public:
+        constexpr ScreenLine() = default;
+
+        /**
+         * @brief Construct a new ScreenLine
+         *
+         * @param text The text of the line, anything past SCREEN_WIDTH characters is cut off
+         */
+        constexpr ScreenLine(std::string_view text)
+            : m_size(std::min(text.size(), SCREEN_WIDTH)) {
+            text.copy(m_text.data(), m_size);
+        }
+
+        /**
+         * @brief Get the text of the line
+         */
+        constexpr std::string_view view() const { return {m_text.data(), m_size}; }
+
+        /**
+         * @brief Get the text of the line as a null-terminated string
+         */
+        constexpr const char* c_str() const { return m_text.data(); }
+
+        constexpr bool empty() const { return m_size == 0; }
+
+        constexpr bool operator==(const ScreenLine& other) const { return this->view() == other.view(); }
+    private:
+        /// The characters of the line, followed by at least one null character
+        std::array<char, SCREEN_WIDTH + 1> m_text {};
+        uint8_t m_size = 0;
+};
+
+/**
+ * @brief A full screen, with the first 3 lines being the lines of text on the controller screen and the last being a
+ * rumble pattern
+ *
+ * Each line is stored inline, and a bitmask records which lines are set, so a buffer never allocates.
+ */
+class ScreenBuffer {
+    public:
+        constexpr ScreenBuffer() = default;
+
+        /**
+         * @brief Whether or not a line is set
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         */
+        constexpr bool has(uint8_t line) const { return m_mask & (1 << line); }
+
+        /**
+         * @brief Get a line, which is empty if it is not set
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         */
+        constexpr const ScreenLine& operator[](uint8_t line) const { return m_lines[line]; }
+
+        /**
+         * @brief Set a line
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         * @param text The text of the line
+         */
+        constexpr void set(uint8_t line, const ScreenLine& text) {
+            m_lines[line] = text;
+            m_mask |= 1 << line;
+        }
+
+        /**
+         * @brief Set a line
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         * @param text The text of the line, anything past SCREEN_WIDTH characters is cut off
+         */
+        constexpr void set(uint8_t line, std::string_view text) { this->set(line, ScreenLine(text)); }
+
+        /**
+         * @brief Unset a line
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         */
+        constexpr void clear(uint8_t line) {
+            m_lines[line] = {};
+            m_mask &= ~(1 << line);
+        }
+
+        /**
+         * @brief Unset every line
+         */
+        constexpr void clear() { *this = {}; }
+
+        /**
+         * @brief Get a bitmask of the lines that are set, where bit n is set if line n is
+         */
+        constexpr uint8_t mask() const { return m_mask; }
+    private:
+        std::array<ScreenLine, 4> m_lines {};
+        uint8_t m_mask = 0;
+};
 
 /**
  * @brief The abstract class for interacting with the controller screen
@@ -36,19 +138,21 @@ class AbstractScreen {
         /**
          * @brief runs if there is an empty line that is available to print
          *
-         * @param visible_lines a set that contains the line numbers of all lines that
-         * are empty and available for printing
+         * @param visible_lines a bitmask of the lines that are empty and available for printing, where bit n is set
+         * if line n is available (bit 3 is the rumble pattern)
          *
-         * @returns a the lines to be printed, any lines that are not available will be ignored
+         * @returns a view of the lines to be printed, which must stay valid until the next call. Any lines that are
+         * not available will be ignored
          */
-        virtual ScreenBuffer getScreen(std::set<uint8_t> visible_lines) = 0;
+        virtual const ScreenBuffer& getScreen(uint8_t visible_lines) = 0;
 
         /**
          * @brief a function where button events are pushed, use this to handle button events.
          *
-         * @param button_events a set of the button events that happened this update
+         * @param button_events a bitmask of the buttons that were pressed this update, where bit n belongs to
+         * E_CONTROLLER_DIGITAL_L1 + n
          */
-        virtual void handleEvents(std::set<pros::controller_digital_e_t> button_events) {}
+        virtual void handleEvents(uint16_t button_events) {}
 
         /**
          * @brief returns the priority of the screen
@@ -57,6 +161,9 @@ class AbstractScreen {
          */
         uint32_t getPriority() { return m_priority; }
     protected:
+        /// A buffer with no lines set, for screens that have nothing to print
+        static constexpr ScreenBuffer EMPTY_BUFFER {};
+
         const uint32_t m_priority;
 };
 
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 #include "abstractScreen.hpp"
+#include "gamepad/recursive_mutex.hpp"
 #include "pros/rtos.hpp"
 #include "gamepad/screens/abstractScreen.hpp"
 
@@ -30,12 +31,11 @@ class AlertScreen : public AbstractScreen {
         /**
          * @brief return the next alert to print if there is space for it on the screen
          *
-         * @param visible_lines a set that contains the line numbers of all lines that
-         * are empty and available for printing
+         * @param visible_lines a bitmask of the lines that are empty and available for printing
          *
-         * @returns a the lines to be printed, any lines that are not available will be ignored
+         * @returns a view of the alert to be printed, valid until the next call
          */
-        ScreenBuffer getScreen(std::set<uint8_t> visible_lines);
+        const ScreenBuffer& getScreen(uint8_t visible_lines) override;
 
         /**
          * @brief add an alert to the alert queue, to be printed as soon as there is an available space
@@ -65,8 +65,9 @@ class AlertScreen : public AbstractScreen {
 
         std::deque<AlertBuffer> m_screen_buffer {};
         std::optional<AlertBuffer> m_screen_contents {};
-        uint32_t m_line_set_time = 0;
-        pros::Mutex m_mutex {};
+        /// How long the current alert has been shown for, in ms
+        uint32_t m_time_shown = 0;
+        _impl::RecursiveMutex m_mutex {};
 };
 
 } // namespace gamepad
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "gamepad/screens/abstractScreen.hpp"
+#include "gamepad/recursive_mutex.hpp"
 #include "pros/rtos.hpp"
+#include <string_view>
 
 namespace gamepad {
 
@@ -19,12 +21,11 @@ class DefaultScreen : public AbstractScreen {
         /**
          * @brief returns any lines that have space to print on the controller
          *
-         * @param visible_lines a set that contains the line numbers of all lines that
-         * are empty and available for printing
+         * @param visible_lines a bitmask of the lines that are empty and available for printing
          *
-         * @returns a the lines to be printed, any lines that are not available will be ignored
+         * @returns a view of the lines to be printed, valid until the next call
          */
-        ScreenBuffer getScreen(std::set<uint8_t> visible_lines);
+        const ScreenBuffer& getScreen(uint8_t visible_lines) override;
 
         /**
          * @brief print a line to the console like pros
@@ -40,7 +41,7 @@ class DefaultScreen : public AbstractScreen {
          * @return 0 if the alert was added successfully
          * @return INT32_MAX if there was an error, setting errno
          */
-        int32_t printLine(uint8_t line, std::string str);
+        int32_t printLine(uint8_t line, std::string_view str);
 
         /**
          * makes the controller rumble like pros
@@ -56,10 +57,13 @@ class DefaultScreen : public AbstractScreen {
          * @return 0 if the alert was added successfully
          * @return INT32_MAX if there was an error, setting errno
          */
-        int32_t rumble(std::string rumble_pattern);
+        int32_t rumble(std::string_view rumble_pattern);
     private:
+        /// The lines that have been printed but not shown yet
         ScreenBuffer m_current_buffer {};
-        pros::Mutex m_mutex {};
+        /// The lines handed out by the last call to getScreen()
+        ScreenBuffer m_output {};
+        _impl::RecursiveMutex m_mutex {};
 };
 
 } // namespace gamepad
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace gamepad {
+
+/**
+ * @brief How long the writes to one line of the controller screen took to show up
+ *
+ * Time-to-display is the time from when a screen hands a line to the Gamepad until the line is sent to the controller.
+ */
+struct LineStats {
+        /// The number of times the line was written
+        uint32_t writes = 0;
+        /// The time-to-display of the last write, in ms
+        uint32_t last = 0;
+        /// The longest time-to-display, in ms
+        uint32_t max = 0;
+        /// The sum of the time-to-display of every write, in ms. Divide it by writes for the average
+        uint64_t total = 0;
+        /// The number of writes that were sent after the deadline of the line had passed
+        uint32_t missed_deadlines = 0;
+};
+
+namespace _impl {
+
+/**
+ * @brief Picks which line of the controller screen gets the next write
+ *
+ * The controller only accepts a write about every 50ms, so when several lines are waiting, each one gets a score and
+ * the highest score is written first. The score is how long the line has been waiting, plus one write interval for
+ * each rank of the screen the line came from. A line that would miss its deadline if it waited
+ * for another write interval is urgent, and is written before every line that is not.
+ */
+class LineScheduler {
+    public:
+        /// The time between writes to the controller, in ms
+        static constexpr uint32_t WRITE_INTERVAL = 50;
+        /// The number of lines, the last one being the rumble pattern
+        static constexpr uint8_t LINE_COUNT = 4;
+
+        /**
+         * @brief Set the most time a line should wait before it is written
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         * @param deadline The deadline in ms, or 0 for no deadline
+         */
+        void setDeadline(uint8_t line, uint32_t deadline);
+
+        /**
+         * @brief Start the wait of a line, if it is not already waiting
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         * @param rank The rank of the screen the line came from, see rank()
+         * @param now The current time in ms
+         */
+        void markPending(uint8_t line, uint32_t rank, uint32_t now);
+
+        /**
+         * @brief Get the rank of a screen from its priority, which is one more for every doubling of the priority
+         *
+         * This depends only on the priority, so adding a screen does not change how lines from the other screens are
+         * scheduled. Since priorities span all of uint32_t, a linear rank would make the alert screen (UINT32_MAX -
+         * 100) outrank the default screen (1) by years of waiting.
+         *
+         * @param priority The priority of the screen
+         */
+        static constexpr uint32_t rank(uint32_t priority) { return std::bit_width(priority); }
+
+        /**
+         * @brief Stop the wait of a line without counting a write, because it no longer needs one
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         */
+        void cancel(uint8_t line);
+
+        /**
+         * @brief Stop the wait of every line
+         */
+        void cancelAll();
+
+        /**
+         * @brief Pick the most urgent waiting line
+         *
+         * @param start The line to start from, so lines with the same score take turns
+         * @param now The current time in ms
+         * @return the line to write next, or LINE_COUNT if no line is waiting
+         */
+        uint8_t pick(uint8_t start, uint32_t now) const;
+
+        /**
+         * @brief Stop the wait of a line, and count its write
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         * @param now The current time in ms
+         */
+        void written(uint8_t line, uint32_t now);
+
+        /**
+         * @brief Get the time-to-display statistics of a line
+         *
+         * @param line The line, from 0 to 2 for text or 3 for the rumble pattern
+         */
+        const LineStats& stats(uint8_t line) const { return m_stats[line]; }
+    private:
+        /// A bitmask of the lines that are waiting to be written
+        uint8_t m_pending = 0;
+        /// When each line started waiting, in ms
+        std::array<uint32_t, LINE_COUNT> m_pending_since {};
+        std::array<uint32_t, LINE_COUNT> m_rank {};
+        /// The deadline of each line in ms, 0 if it has none
+        std::array<uint32_t, LINE_COUNT> m_deadline {};
+        std::array<LineStats, LINE_COUNT> m_stats {};
+};
+
+} // namespace _impl
+
+} // namespace gamepad
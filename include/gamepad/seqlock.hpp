@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace gamepad::_impl {
+
+/**
+ * @brief Publishes a value from one writer task to any number of reader tasks, without locks
+ *
+ * The value is double buffered, and each buffer is guarded by a sequence number. The writer always writes the buffer
+ * readers are not directed to, so a reader only has to retry if the writer finishes two whole writes while the reader
+ * is copying. A preempted writer can therefore never make a higher priority reader spin.
+ *
+ * @tparam T the type of the value, this must be trivially copyable
+ */
+template <typename T> class Seqlock {
+        static_assert(std::is_trivially_copyable_v<T>, "Seqlock values must be trivially copyable");
+        static_assert(std::is_default_constructible_v<T>, "Seqlock values must be default constructible");
+    public:
+        /**
+         * @brief Publish a new value, this must only be called by the writer
+         *
+         * @param value the value to publish
+         */
+        void store(const T& value) {
+            std::array<uint32_t, WORDS> words {};
+            std::memcpy(words.data(), &value, sizeof(T));
+            uint32_t index = m_index.load(std::memory_order_relaxed) + 1;
+            Buffer& buffer = m_buffers[index % 2];
+            uint32_t sequence = buffer.sequence.load(std::memory_order_relaxed);
+            // an odd sequence number marks the buffer as being written
+            buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < WORDS; i++) buffer.words[i].store(words[i], std::memory_order_relaxed);
+            buffer.sequence.store(sequence + 2, std::memory_order_release);
+            m_index.store(index, std::memory_order_release);
+        }
+
+        /**
+         * @brief Get a coherent copy of the latest value, this can be called from any task
+         */
+        T load() const {
+            std::array<uint32_t, WORDS> words;
+            while (true) {
+                const Buffer& buffer = m_buffers[m_index.load(std::memory_order_acquire) % 2];
+                uint32_t before = buffer.sequence.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < WORDS; i++) words[i] = buffer.words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (before % 2 == 0 && buffer.sequence.load(std::memory_order_relaxed) == before) break;
+            }
+            T value;
+            std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+            return value;
+        }
+    private:
+        static constexpr std::size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+        struct Buffer {
+                std::atomic<uint32_t> sequence = 0;
+                std::array<std::atomic<uint32_t>, WORDS> words {};
+        };
+
+        /// Which buffer holds the latest value
+        std::atomic<uint32_t> m_index = 0;
+        std::array<Buffer, 2> m_buffers {};
+};
+} // namespace gamepad::_impl
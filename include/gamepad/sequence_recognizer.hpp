@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gamepad/event_handler.hpp"
+#include "gamepad/recursive_mutex.hpp"
+
+#ifndef GAMEPAD_MAX_SEQUENCES
+/// The maximum number of sequences each gamepad can recognize, define this in the Makefile to change it
+#define GAMEPAD_MAX_SEQUENCES 16
+#endif
+
+namespace gamepad::_impl {
+
+/**
+ * @brief Recognizes timed sequences of button presses, such as Up, Up, Down, A
+ *
+ * Every registered sequence is compiled into one shared automaton (an Aho-Corasick automaton over the 12 buttons), so
+ * each button press advances the automaton with a single table lookup, no matter how many sequences are registered.
+ * The automaton is rebuilt whenever a sequence is added or removed, so recognizing presses never allocates.
+ */
+class SequenceRecognizer {
+    public:
+        /// The number of buttons sequences are made of
+        static constexpr uint8_t BUTTON_COUNT = 12;
+        /// The most states the automaton can have, which is one more than the total length of every sequence at most
+        static constexpr uint32_t MAX_STATES = UINT16_MAX;
+
+        /**
+         * @brief Add a sequence to recognize
+         *
+         * @param name The name of the sequence (this must be a unique name)
+         * @param buttons The indices of the buttons in the sequence, from 0 for L1 to 11 for A
+         * @param func The function to run when the sequence is recognized
+         *
+         * This function uses the following value(s) of errno when an error state is reached:
+         *
+         * EEXIST: There is already a sequence with the same name
+         *
+         * ENOMEM: GAMEPAD_MAX_SEQUENCES sequences are already registered
+         *
+         * E2BIG: The sequences would need more than MAX_STATES states
+         *
+         * @return 0 The sequence was successfully added
+         * @return INT32_MAX The sequence was NOT successfully added, setting errno
+         */
+        int32_t add(std::string name, std::vector<uint8_t> buttons, InplaceFunction<void()> func);
+
+        /**
+         * @brief Remove a sequence
+         *
+         * @param name The name of the sequence
+         * @return 0 The sequence was successfully removed
+         * @return INT32_MAX The sequence was NOT successfully removed (there is no sequence with the same name)
+         */
+        int32_t remove(const std::string& name);
+
+        /**
+         * @brief Set the most time that can pass between two presses of a sequence
+         *
+         * @param timeout the timeout in ms
+         */
+        void setTimeout(uint32_t timeout);
+
+        /**
+         * @brief Advance the automaton by one button press, and run the listeners of every sequence it completes
+         *
+         * @note the automaton goes back to its start after a sequence is recognized, so a press is never part of
+         * two recognized sequences that end at different presses
+         * @note the listeners run while the mutex is held, so a sequence can not be removed from another task while
+         * its listener is running
+         *
+         * @param button The index of the button that was pressed, from 0 for L1 to 11 for A
+         * @param now The time of the press in µs
+         */
+        void advance(uint8_t button, uint64_t now);
+    private:
+        struct Sequence {
+                std::string name;
+                std::vector<uint8_t> buttons;
+                ListenerHandle handle;
+        };
+
+        /**
+         * @brief Rebuild the automaton from the registered sequences, the mutex must be held
+         */
+        void compile();
+
+        /// The registered sequences, indexed by the slot of their listener
+        std::array<std::optional<Sequence>, GAMEPAD_MAX_SEQUENCES> m_sequences {};
+        EventHandler<uint8_t, GAMEPAD_MAX_SEQUENCES> m_listeners {};
+        /// The next state for each state and button
+        std::vector<std::array<uint16_t, BUTTON_COUNT>> m_transitions {};
+        /// A bitmask of the listener slots of the sequences recognized in each state
+        std::vector<uint64_t> m_outputs {};
+        /// The total length of every registered sequence
+        uint32_t m_length = 0;
+        uint16_t m_state = 0;
+        uint64_t m_last_press_time = 0;
+        uint32_t m_timeout = 300;
+        RecursiveMutex m_mutex {};
+};
+} // namespace gamepad::_impl
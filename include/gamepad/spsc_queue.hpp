@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace gamepad::_impl {
+
+/**
+ * @brief A bounded, lock-free queue for passing values from exactly one producer task to exactly one consumer task
+ *
+ * All storage is allocated inline, and neither push() nor pop() ever blocks.
+ *
+ * @tparam T the type of value to store, this should be small and trivially copyable
+ * @tparam Capacity the maximum number of values the queue can hold (must be a power of 2)
+ */
+template <typename T, std::size_t Capacity> class SpscQueue {
+        static_assert(std::has_single_bit(Capacity), "SpscQueue capacity must be a power of 2");
+    public:
+        /**
+         * @brief Add a value to the back of the queue, this must only be called by the producer
+         *
+         * @param value the value to add
+         * @return true The value was added
+         * @return false The queue is full, and the value was not added
+         */
+        bool push(const T& value) {
+            uint32_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) == Capacity) return false;
+            m_buffer[head % Capacity] = value;
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Remove the value at the front of the queue, this must only be called by the consumer
+         *
+         * @param value where to store the removed value
+         * @return true A value was removed
+         * @return false The queue is empty
+         */
+        bool pop(T& value) {
+            uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire)) return false;
+            value = m_buffer[tail % Capacity];
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Get the number of values in the queue
+         *
+         * @note the result may already be out of date if the other task is using the queue
+         */
+        std::size_t size() const { return m_head.load() - m_tail.load(); }
+    private:
+        std::array<T, Capacity> m_buffer {};
+        std::atomic<uint32_t> m_head = 0;
+        std::atomic<uint32_t> m_tail = 0;
+};
+} // namespace gamepad::_impl
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <chrono>
+#else
+#include "pros/rtos.h"
+#endif
+
+#ifndef GAMEPAD_PROFILE
+/// Set this to 1 in the Makefile to time each phase of Gamepad::update(), see Gamepad::profile()
+#define GAMEPAD_PROFILE 0
+#endif
+
+namespace gamepad {
+
+/**
+ * @brief The phases of Gamepad::update()
+ */
+enum UpdatePhase {
+    /// Reading the buttons, joysticks and connection state from the controller or the input source
+    PHASE_SAMPLING = 0,
+    /// The press, release, hold and tap timing of every button, and chords
+    PHASE_BUTTONS,
+    /// Running (or queueing) the listeners of the events that happened
+    PHASE_DISPATCH,
+    /// Normalizing the joysticks, and publishing the snapshot and the history
+    PHASE_AXES,
+    /// Evaluating the joystick transformations
+    PHASE_TRANSFORM,
+    /// Updating the screens, and writing to the controller
+    PHASE_SCREENS,
+    PHASE_COUNT,
+};
+
+/**
+ * @brief The time Gamepad::update() has spent in each of its phases
+ */
+struct UpdateProfile {
+        /// The number of updates that were timed
+        uint32_t updates = 0;
+        /// The total time spent in each phase in ns, indexed by UpdatePhase
+        std::array<uint64_t, PHASE_COUNT> ns {};
+};
+
+namespace _impl {
+
+/**
+ * @brief Adds the time between consecutive laps to the phases of an UpdateProfile, when GAMEPAD_PROFILE is set
+ *
+ * When GAMEPAD_PROFILE is not set, every method is empty, so the timing compiles away entirely.
+ */
+class PhaseTimer {
+    public:
+        /**
+         * @brief Start timing the first phase
+         *
+         * @param profile The profile to add the times to
+         */
+        explicit PhaseTimer(UpdateProfile& profile)
+            : m_profile(profile),
+              m_last(now()) {}
+
+        /**
+         * @brief End the current phase, and start the next one
+         *
+         * @param phase The phase that ended
+         * @param excluded Time in ns that was already counted by another phase nested inside this one
+         */
+        void lap(UpdatePhase phase, uint64_t excluded = 0) {
+            if constexpr (GAMEPAD_PROFILE) {
+                uint64_t time = now();
+                m_profile.ns[phase] += time - m_last - excluded;
+                m_last = time;
+            }
+        }
+
+        /**
+         * @brief Get the current time in ns, or 0 if GAMEPAD_PROFILE is not set
+         */
+        static uint64_t now() {
+            if constexpr (!GAMEPAD_PROFILE) return 0;
+#if defined(__linux__)
+            auto time = std::chrono::steady_clock::now().time_since_epoch();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+#else
+            // the brain has no finer clock
+            return pros::c::micros() * 1000;
+#endif
+        }
+    private:
+        UpdateProfile& m_profile;
+        uint64_t m_last;
+};
+} // namespace _impl
+} // namespace gamepad
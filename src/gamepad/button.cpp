@@ -1,10 +1,11 @@
 #include "gamepad/button.hpp"
 #include "gamepad/todo.hpp"
 #include "pros/rtos.hpp"
+#include <bit>
 #include <cstdint>
 
 namespace gamepad {
-_impl::EventHandler<std::string>* Button::get_handler(EventType event) const {
+_impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS>* Button::get_handler(EventType event) const {
     switch (event) {
         case gamepad::EventType::ON_PRESS: return &m_on_press_event;
         case gamepad::EventType::ON_LONG_PRESS: return &m_on_long_press_event;
@@ -12,6 +13,8 @@ _impl::EventHandler<std::string>* Button::get_handler(EventType event) const {
         case gamepad::EventType::ON_SHORT_RELEASE: return &m_on_short_release_event;
         case gamepad::EventType::ON_LONG_RELEASE: return &m_on_long_release_event;
         case gamepad::EventType::ON_REPEAT_PRESS: return &m_on_repeat_press_event;
+        case gamepad::EventType::ON_DOUBLE_TAP: return &m_on_double_tap_event;
+        case gamepad::EventType::ON_MULTI_TAP: return &m_on_multi_tap_event;
         default: return nullptr;
     }
 }
@@ -20,34 +23,48 @@ void Button::setLongPressThreshold(uint32_t threshold) const { m_long_press_thre
 
 void Button::setRepeatCooldown(uint32_t cooldown) const { m_repeat_cooldown = cooldown; }
 
+void Button::setTapWindow(uint32_t window) const { m_tap_window = window; }
+
+void Button::setDelayPressForTaps(bool delay) const { m_delay_press_for_taps = delay; }
+
 int32_t Button::onPress(std::string listenerName, std::function<void(void)> func) const {
-    return m_on_press_event.addListener(std::move(listenerName) + "_user", std::move(func));
+    return this->addListener(ON_PRESS, std::move(listenerName), std::move(func));
 }
 
 int32_t Button::onLongPress(std::string listenerName, std::function<void(void)> func) const {
-    return m_on_long_press_event.addListener(std::move(listenerName) + "_user", std::move(func));
+    return this->addListener(ON_LONG_PRESS, std::move(listenerName), std::move(func));
 }
 
 int32_t Button::onRelease(std::string listenerName, std::function<void(void)> func) const {
-    return m_on_release_event.addListener(std::move(listenerName) + "_user", std::move(func));
+    return this->addListener(ON_RELEASE, std::move(listenerName), std::move(func));
 }
 
 int32_t Button::onShortRelease(std::string listenerName, std::function<void(void)> func) const {
-    return m_on_short_release_event.addListener(std::move(listenerName) + "_user", std::move(func));
+    return this->addListener(ON_SHORT_RELEASE, std::move(listenerName), std::move(func));
 }
 
 int32_t Button::onLongRelease(std::string listenerName, std::function<void(void)> func) const {
-    return m_on_long_release_event.addListener(std::move(listenerName) + "_user", std::move(func));
+    return this->addListener(ON_LONG_RELEASE, std::move(listenerName), std::move(func));
 }
 
 int32_t Button::onRepeatPress(std::string listenerName, std::function<void(void)> func) const {
-    return m_on_repeat_press_event.addListener(std::move(listenerName) + "_user", std::move(func));
+    return this->addListener(ON_REPEAT_PRESS, std::move(listenerName), std::move(func));
+}
+
+int32_t Button::onDoubleTap(std::string listenerName, std::function<void(void)> func) const {
+    return this->addListener(ON_DOUBLE_TAP, std::move(listenerName), std::move(func));
+}
+
+int32_t Button::onMultiTap(std::string listenerName, std::function<void(void)> func) const {
+    return this->addListener(ON_MULTI_TAP, std::move(listenerName), std::move(func));
 }
 
 int32_t Button::addListener(EventType event, std::string listenerName, std::function<void(void)> func) const {
     auto handler = this->get_handler(event);
     if (handler != nullptr) {
-        return handler->addListener(listenerName + "_user", func);
+        int32_t ret = handler->addListener(std::move(listenerName) + "_user", std::move(func));
+        this->updateInterest(event);
+        return ret;
     } else {
         TODO("add error logging")
         errno = EINVAL;
@@ -55,16 +72,25 @@ int32_t Button::addListener(EventType event, std::string listenerName, std::func
     }
 }
 
+ListenerHandle Button::addListener(EventType event, _impl::InplaceFunction<void(void)> func) const {
+    auto handler = this->get_handler(event);
+    if (handler == nullptr) {
+        TODO("add error logging")
+        errno = EINVAL;
+        return {};
+    }
+    ListenerHandle handle = handler->addListener(std::move(func));
+    if (handle.isValid()) handle.tag = event;
+    this->updateInterest(event);
+    return handle;
+}
+
 int32_t Button::removeListener(EventType event, std::string listenerName) const {
-    return m_on_press_event.removeListener(listenerName + "_user") ||
-           m_on_long_press_event.removeListener(listenerName + "_user") ||
-           m_on_release_event.removeListener(listenerName + "_user") ||
-           m_on_short_release_event.removeListener(listenerName + "_user") ||
-           m_on_long_release_event.removeListener(listenerName + "_user") ||
-           m_on_repeat_press_event.removeListener(listenerName + "_user");
     auto handler = this->get_handler(event);
     if (handler != nullptr) {
-        return handler->removeListener(listenerName + "_user");
+        int32_t ret = handler->removeListener(std::move(listenerName) + "_user");
+        this->updateInterest(event);
+        return ret;
     } else {
         TODO("add error logging")
         errno = EINVAL;
@@ -72,34 +98,126 @@ int32_t Button::removeListener(EventType event, std::string listenerName) const
     }
 }
 
-void Button::update(const bool is_held) {
+int32_t Button::removeListener(ListenerHandle handle) const {
+    auto handler = this->get_handler(static_cast<EventType>(handle.tag));
+    if (handler != nullptr) {
+        int32_t ret = handler->removeListener(handle);
+        this->updateInterest(static_cast<EventType>(handle.tag));
+        return ret;
+    } else {
+        TODO("add error logging")
+        errno = EINVAL;
+        return INT32_MAX;
+    }
+}
+
+void Button::updateInterest(EventType event) const {
+    const uint8_t bit = 1 << event;
+    auto handler = this->get_handler(event);
+    if (handler->isEmpty()) m_interest &= ~bit;
+    // check again, in case another task added a listener after the first check
+    if (!handler->isEmpty()) m_interest |= bit;
+}
+
+uint8_t Button::update(const bool is_held, const uint64_t now) {
+    const uint64_t long_press_threshold = uint64_t(m_long_press_threshold) * 1000;
+    const uint64_t repeat_cooldown = uint64_t(m_repeat_cooldown) * 1000;
+    // chords can be registered from other tasks, so the delay is read once for the whole update
+    const uint32_t press_delay = m_press_delay.load();
+    const uint8_t interest = m_interest.load();
+    // the long press and repeat timers, and tap counting, only run if something would use their events
+    const bool track_holds = interest & ((1 << ON_LONG_PRESS) | (1 << ON_REPEAT_PRESS));
+    const bool track_taps = m_delay_press_for_taps || (interest & ((1 << ON_DOUBLE_TAP) | (1 << ON_MULTI_TAP)));
+    // end the previous series of taps before this update can start a new one
+    const uint8_t tap_events = this->endTaps(now);
+    uint8_t events = 0;
     this->rising_edge = !this->is_pressed && is_held;
     this->falling_edge = this->is_pressed && !is_held;
     this->is_pressed = is_held;
-    if (is_held) this->time_held += pros::millis() - m_last_update_time;
-    else this->time_released += pros::millis() - m_last_update_time;
+    if (is_held) this->time_held_us += now - m_last_update_time;
+    else this->time_released_us += now - m_last_update_time;
+
+    // a press held back for a chord is delivered once the chord can no longer be completed
+    if (m_press_pending && (this->falling_edge || this->time_held_us >= uint64_t(press_delay) * 1000)) {
+        events |= 1 << ON_PRESS;
+        m_press_pending = false;
+    }
 
     if (this->rising_edge) {
-        m_on_press_event.fire();
-    } else if (this->is_pressed && this->time_held >= m_long_press_threshold &&
-               m_last_long_press_time <= pros::millis() - this->time_held) {
-        m_on_long_press_event.fire();
-        m_last_long_press_time = pros::millis();
-        m_last_repeat_time = pros::millis() - m_repeat_cooldown;
+        if (press_delay == 0) events |= 1 << ON_PRESS;
+        else m_press_pending = true;
+    } else if (track_holds && this->is_pressed && this->time_held_us >= long_press_threshold &&
+               m_last_long_press_time <= now - this->time_held_us) {
+        events |= 1 << ON_LONG_PRESS;
+        m_last_long_press_time = now;
+        m_last_repeat_time = now - repeat_cooldown;
         this->repeat_iterations = 0;
-    } else if (this->is_pressed && this->time_held >= m_long_press_threshold &&
-               pros::millis() - m_last_repeat_time >= m_repeat_cooldown) {
+    } else if (track_holds && this->is_pressed && this->time_held_us >= long_press_threshold &&
+               now - m_last_repeat_time >= repeat_cooldown) {
         this->repeat_iterations++;
-        m_on_repeat_press_event.fire();
-        m_last_repeat_time = pros::millis();
+        events |= 1 << ON_REPEAT_PRESS;
+        m_last_repeat_time = now;
     } else if (this->falling_edge) {
-        m_on_release_event.fire();
-        if (this->time_held < m_long_press_threshold) m_on_short_release_event.fire();
-        else m_on_long_release_event.fire();
+        events |= 1 << ON_RELEASE;
+        if (this->time_held_us < long_press_threshold) events |= 1 << ON_SHORT_RELEASE;
+        else events |= 1 << ON_LONG_RELEASE;
+    }
+
+    if (track_taps && this->rising_edge) {
+        if (m_taps_pending) {
+            this->tap_count++;
+            // a second tap means the first one was not a single press after all
+            m_tap_press_pending = false;
+        } else {
+            this->tap_count = 1;
+        }
+        if (this->tap_count == 2) events |= 1 << ON_DOUBLE_TAP;
+        m_taps_pending = true;
+        m_last_tap_time = now;
+    }
+    if (m_delay_press_for_taps && (events & (1 << ON_PRESS))) {
+        // the press of the first tap is delivered once the series of taps is over, if there is no second tap
+        events &= ~(1 << ON_PRESS);
+        if (this->tap_count == 1) m_tap_press_pending = true;
     }
+    events |= tap_events;
 
-    if (this->rising_edge) this->time_held = 0;
-    if (this->falling_edge) this->time_released = 0;
-    m_last_update_time = pros::millis();
+    if (this->rising_edge) this->time_held_us = 0;
+    if (this->falling_edge) this->time_released_us = 0;
+    this->time_held = this->time_held_us / 1000;
+    this->time_released = this->time_released_us / 1000;
+    m_last_update_time = now;
+
+    // the button is part of a chord that claimed its events, until it is released
+    if (m_suppressed) {
+        events = 0;
+        m_press_pending = false;
+        m_taps_pending = false;
+        m_tap_press_pending = false;
+        if (!this->is_pressed) m_suppressed = false;
+    }
+    return events;
+}
+
+uint8_t Button::updateReleased(uint64_t now) {
+    this->time_released_us += now - m_last_update_time;
+    this->time_released = this->time_released_us / 1000;
+    m_last_update_time = now;
+    return this->endTaps(now);
+}
+
+uint8_t Button::endTaps(uint64_t now) {
+    if (!m_taps_pending || now - m_last_tap_time <= uint64_t(m_tap_window) * 1000) return 0;
+    uint8_t events = 1 << ON_MULTI_TAP;
+    if (m_tap_press_pending) events |= 1 << ON_PRESS;
+    m_taps_pending = false;
+    m_tap_press_pending = false;
+    return events;
+}
+
+void Button::fire(uint8_t events) const {
+    for (; events != 0; events &= events - 1) {
+        this->get_handler(static_cast<EventType>(std::countr_zero(events)))->fire();
+    }
 }
 } // namespace gamepad
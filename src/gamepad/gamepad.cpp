@@ -3,124 +3,537 @@
 #include "pros/misc.h"
 #include "pros/rtos.hpp"
 #include "screens/abstractScreen.hpp"
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cerrno>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <tuple>
+#include <utility>
 #include <atomic>
 
 namespace gamepad {
-Gamepad::Gamepad(pros::controller_id_e_t id)
-    : m_controller(id) {
+void Gamepad::init() {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    if (m_default_screen != nullptr) return;
+    m_default_screen = std::make_shared<DefaultScreen>();
     this->addScreen(m_default_screen);
 }
 
-void Gamepad::updateButton(pros::controller_digital_e_t button_id) {
-    Button Gamepad::* button = Gamepad::buttonToPtr(button_id);
-    bool is_held = m_controller.get_digital(button_id);
-    (this->*button).update(is_held);
+DefaultScreen& Gamepad::defaultScreen() {
+    this->init();
+    return *m_default_screen;
 }
 
-void Gamepad::updateScreens() {
-    // Lock Mutexes for Thread Safety
-    std::lock_guard<pros::Mutex> guard_scheduling(m_mutex);
+uint16_t Gamepad::readButtons() const {
+    uint16_t state = 0;
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        auto button_id = static_cast<pros::controller_digital_e_t>(pros::E_CONTROLLER_DIGITAL_L1 + i);
+        if (pros::c::controller_get_digital(m_id, button_id)) state |= 1 << i;
+    }
+    return state;
+}
 
-    // Disable screen updates if the controller is disconnected
-    if (!m_controller.is_connected()) {
-        if (m_screen_cleared) {
-            m_next_buffer = std::move(m_current_screen);
-            m_current_screen = {};
-            m_screen_cleared = false;
+bool Gamepad::readFrame(InputFrame& frame) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    if (m_source != nullptr) {
+        if (!m_source->read(frame)) return false;
+    } else {
+        frame.timestamp = _impl::micros();
+        frame.connected = pros::c::controller_is_connected(m_id);
+        for (uint8_t i = 0; i < frame.axes.size(); i++) {
+            auto axis = static_cast<pros::controller_analog_e_t>(pros::E_CONTROLLER_ANALOG_LEFT_X + i);
+            frame.axes[i] = pros::c::controller_get_analog(m_id, axis);
+        }
+        if (m_sampling_task.load() == nullptr) {
+            frame.buttons = this->readButtons();
+        } else {
+            // take the edges recorded since the last update, leaving only the state behind
+            uint64_t sample = m_sample.load();
+            while (!m_sample.compare_exchange_weak(sample, sample & 0xFFFF)) {}
+            frame.buttons = sample;
+            uint16_t edges = (sample >> 16) | (sample >> 32);
+            frame.toggled = edges & ~(frame.buttons ^ m_button_state);
         }
+    }
+    // continue from the last update when the source changes or the clock goes backwards, every button, chord,
+    // sequence and screen subtracts older timestamps from this one
+    if (m_last_time != 0 && (m_source_changed || frame.timestamp + m_time_offset < m_last_time)) {
+        m_time_offset = m_last_time - frame.timestamp;
+    }
+    m_source_changed = false;
+    frame.timestamp += m_time_offset;
+    m_last_time = frame.timestamp;
+    if (m_sink != nullptr) m_sink->record(frame);
+    return true;
+}
+
+void Gamepad::updateButtons(const InputFrame& frame) {
+    const uint64_t now = frame.timestamp;
+    // a button that was pressed and released (or released and pressed) since the last update ended up where it
+    // started, so it is first updated with the state it was in between
+    uint16_t rising = 0, falling = 0;
+    if (frame.toggled != 0) {
+        this->applyButtons(m_button_state ^ frame.toggled, now);
+        rising = m_rising_edges;
+        falling = m_falling_edges;
+    }
+    this->applyButtons(frame.buttons, now);
+    // keep the edges of both updates, so the screens and the snapshot see every press and release
+    m_rising_edges |= rising;
+    m_falling_edges |= falling;
+}
+
+void Gamepad::sampleButtons() {
+    uint32_t wake_time = pros::millis();
+    while (true) {
+        uint64_t state = this->readButtons();
+        uint64_t sample = m_sample.load();
+        uint64_t next;
+        do {
+            uint64_t changed = state ^ (sample & 0xFFFF);
+            next = (sample & ~uint64_t(0xFFFF)) | state | (changed & state) << 16 | (changed & ~state) << 32;
+        } while (!m_sample.compare_exchange_weak(sample, next));
+        pros::c::task_delay_until(&wake_time, m_sample_period);
+    }
+}
+
+void Gamepad::applyButtons(uint16_t state, uint64_t now) {
+    uint16_t changed = state ^ m_button_state;
+    // buttons with an edge from the last update still need their edge flags cleared
+    uint16_t active = changed | state | m_rising_edges | m_falling_edges;
+    m_rising_edges = changed & state;
+    m_falling_edges = changed & m_button_state;
+    m_button_state = state;
+    this->updateChords(now);
+
+    for (uint16_t bits = active; bits != 0; bits &= bits - 1) {
+        uint8_t i = std::countr_zero(bits);
+        this->updateButton(i, state & (1 << i), now);
+    }
+
+    // every other button has been released for a while, so the only thing to do is track how long, and end any taps
+    for (uint16_t bits = ~active & ((1 << BUTTON_COUNT) - 1); bits != 0; bits &= bits - 1) {
+        uint8_t i = std::countr_zero(bits);
+        uint8_t events = (this->*BUTTONS[i]).updateReleased(now);
+        if (events != 0) this->dispatch(i, events, now);
+    }
+
+    for (uint16_t bits = m_rising_edges; bits != 0; bits &= bits - 1) m_sequences.advance(std::countr_zero(bits), now);
+}
+
+void Gamepad::updateButton(uint8_t index, bool is_held, uint64_t now) {
+    Button& button = this->*BUTTONS[index];
+    uint8_t events = button.update(is_held, now);
+    if (events != 0) this->dispatch(index, events, now);
+}
+
+void Gamepad::dispatch(uint8_t index, uint8_t events, uint64_t now) {
+    Button& button = this->*BUTTONS[index];
+    m_fired_events[index] |= events;
+    m_fired_buttons |= 1 << index;
+    // events without listeners are dropped here, before they cost a call to fire() or a spot in the queue
+    uint8_t unheard = events & ~button.m_interest.load();
+    if (unheard != 0) {
+        m_skipped_events += std::popcount(unheard);
+        events &= ~unheard;
+        if (events == 0) return;
+    }
+    _impl::PhaseTimer timer(m_profile);
+    if (m_dispatch_task.load() == nullptr) {
+        button.fire(events);
+        timer.lap(PHASE_DISPATCH);
         return;
     }
 
-    // Clear current screen and reset last update time on reconnect
-    if (m_controller.is_connected() && !m_screen_cleared) {
-        m_current_screen = {};
-        m_last_update_time = pros::millis();
+    // the dispatcher task will run the listeners, so only record the events
+    for (; events != 0; events &= events - 1) {
+        EventRecord record {static_cast<uint32_t>(now), index, static_cast<uint8_t>(std::countr_zero(events))};
+        if (!m_event_queue.push(record)) m_dropped_events++;
+    }
+    uint32_t queued = m_event_queue.size();
+    if (queued > m_max_queued_events.load()) m_max_queued_events = queued;
+    timer.lap(PHASE_DISPATCH);
+}
+
+void Gamepad::recordEvents(uint64_t now) {
+    if (m_fired_buttons == 0) return;
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    for (uint16_t bits = m_fired_buttons; bits != 0; bits &= bits - 1) {
+        uint8_t i = std::countr_zero(bits);
+        auto button_id = static_cast<pros::controller_digital_e_t>(pros::E_CONTROLLER_DIGITAL_L1 + i);
+        if (m_sink != nullptr) m_sink->recordEvents(now, button_id, m_fired_events[i]);
+        m_fired_events[i] = 0;
     }
+    m_fired_buttons = 0;
+}
 
-    // Get new button presses
-    std::set<pros::controller_digital_e_t> buttonUpdates;
-    for (int i = pros::E_CONTROLLER_DIGITAL_L1; i <= pros::E_CONTROLLER_DIGITAL_A; ++i) {
-        if ((this->*this->buttonToPtr(static_cast<pros::controller_digital_e_t>(i))).rising_edge) {
-            buttonUpdates.emplace(static_cast<pros::controller_digital_e_t>(i));
+void Gamepad::updateChords(uint64_t now) {
+    for (uint16_t bits = m_rising_edges; bits != 0; bits &= bits - 1) m_press_times[std::countr_zero(bits)] = now;
+    const uint16_t held = m_button_state & m_chord_buttons.load();
+    if ((m_rising_edges & held) == 0) return;
+
+    // collect the completed chords while holding the lock, but run their listeners after releasing it
+    // the handlers are shared, so a chord removed by another task in the meantime is still safe to fire
+    std::array<std::shared_ptr<_impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS>>, 16> completed {};
+    // a chord can only be completed by a button that was just pressed, so only check the combinations of held
+    // buttons that include one. This costs the same no matter how many chords are registered.
+    uint16_t mask = held;
+    while (mask != 0) {
+        // once completed is full, its chords are run, and the search picks up where it left off
+        size_t count = 0;
+        {
+            std::lock_guard lock(m_chord_mutex);
+            for (; mask != 0 && count < completed.size(); mask = (mask - 1) & held) {
+                if ((mask & m_rising_edges) == 0 || std::popcount(mask) < 2) continue;
+                auto chord = this->findChord(mask);
+                if (chord == m_chords.end() || chord->mask != mask) continue;
+
+                uint64_t first = UINT64_MAX, last = 0;
+                for (uint16_t bits = mask; bits != 0; bits &= bits - 1) {
+                    first = std::min(first, m_press_times[std::countr_zero(bits)]);
+                    last = std::max(last, m_press_times[std::countr_zero(bits)]);
+                }
+                if (last - first > uint64_t(chord->window) * 1000) continue;
+
+                if (chord->suppress) {
+                    for (uint16_t bits = mask; bits != 0; bits &= bits - 1) {
+                        (this->*BUTTONS[std::countr_zero(bits)]).m_suppressed = true;
+                    }
+                }
+                completed[count++] = chord->handler;
+            }
         }
+        for (size_t i = 0; i < count; i++) completed[i]->fire();
     }
+}
 
-    // Update all screens, and send new button presses, also note deltatime
-    for (std::shared_ptr<AbstractScreen> screen : m_screens) {
-        screen->update(pros::millis() - m_last_update_time);
-        screen->handleEvents(buttonUpdates);
+void Gamepad::updateChordButtons() {
+    // hold back the press events of buttons in suppressing chords for long enough that any of them can be completed
+    std::array<uint32_t, BUTTON_COUNT> press_delays {};
+    uint16_t chord_buttons = 0;
+    for (const Chord& chord : m_chords) {
+        chord_buttons |= chord.mask;
+        if (!chord.suppress) continue;
+        for (uint16_t bits = chord.mask; bits != 0; bits &= bits - 1) {
+            uint32_t& delay = press_delays[std::countr_zero(bits)];
+            delay = std::max(delay, chord.window);
+        }
     }
-    m_last_update_time = pros::millis();
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) (this->*BUTTONS[i]).m_press_delay = press_delays[i];
+    m_chord_buttons = chord_buttons;
+}
 
-    // Check if enough time has passed for the Gamepad to poll for updates
-    if (pros::millis() - m_last_print_time <= 50) return;
+std::vector<Gamepad::Chord>::iterator Gamepad::findChord(uint16_t mask) {
+    return std::lower_bound(m_chords.begin(), m_chords.end(), mask,
+                            [](const Chord& chord, uint16_t mask) { return chord.mask < mask; });
+}
 
-    for (std::shared_ptr<AbstractScreen> screen : m_screens) {
-        // get all lines that aren't being used by a higher priority screen
-        std::set<uint8_t> visible_lines;
-        for (uint8_t j = 0; j < 4; j++)
-            if (!m_next_buffer[j].has_value()) visible_lines.emplace(j);
+uint16_t Gamepad::chordMask(const std::vector<pros::controller_digital_e_t>& buttons) {
+    uint16_t mask = 0;
+    for (pros::controller_digital_e_t button : buttons) {
+        if (button < pros::E_CONTROLLER_DIGITAL_L1 || button > pros::E_CONTROLLER_DIGITAL_A) return 0;
+        mask |= 1 << (button - pros::E_CONTROLLER_DIGITAL_L1);
+    }
+    return std::popcount(mask) >= 2 ? mask : 0;
+}
 
-        // get the buffer of the next lower priority screen and set it to be printed
-        ScreenBuffer buffer = screen->getScreen(visible_lines);
-        for (uint8_t j = 0; j < 4; j++)
-            if (buffer[j].has_value() && !buffer[j]->empty() && !m_next_buffer[j].has_value())
-                m_next_buffer[j] = std::move(buffer[j]);
+int32_t Gamepad::onChord(std::string listenerName, std::vector<pros::controller_digital_e_t> buttons,
+                         std::function<void(void)> func, uint32_t window, bool suppress) {
+    const uint16_t mask = Gamepad::chordMask(buttons);
+    if (mask == 0) {
+        TODO("add error logging")
+        errno = EINVAL;
+        return INT32_MAX;
     }
 
-    for (int i = 0; i < 4; i++) {
-        // start from the line thats after the line thats been set so we dont get stuck setting the first line
-        int line = (m_last_printed_line + i) % 4;
+    std::lock_guard lock(m_chord_mutex);
+    auto chord = this->findChord(mask);
+    if (chord == m_chords.end() || chord->mask != mask) {
+        auto handler = std::make_shared<_impl::EventHandler<std::string, GAMEPAD_MAX_LISTENERS>>();
+        chord = m_chords.insert(chord, {mask, window, suppress, std::move(handler)});
+    }
+    const int32_t ret = chord->handler->addListener(std::move(listenerName), std::move(func));
+    // a listener that was not added leaves the options of the chord as they were
+    if (ret == 0) {
+        chord->window = window;
+        chord->suppress = suppress;
+    }
+    // a chord that was just created for this listener is only kept if the listener was added
+    if (chord->handler->isEmpty()) m_chords.erase(chord);
+    this->updateChordButtons();
+    return ret;
+}
 
-        // theres nothing on this line so we can skip it
-        if (!m_next_buffer[line].has_value()) continue;
+int32_t Gamepad::removeChord(std::string listenerName, std::vector<pros::controller_digital_e_t> buttons) {
+    const uint16_t mask = Gamepad::chordMask(buttons);
+    if (mask == 0) {
+        TODO("add error logging")
+        errno = EINVAL;
+        return INT32_MAX;
+    }
+
+    std::lock_guard lock(m_chord_mutex);
+    auto chord = this->findChord(mask);
+    if (chord == m_chords.end() || chord->mask != mask) return INT32_MAX;
+    const int32_t ret = chord->handler->removeListener(std::move(listenerName));
+    // the last listener takes the chord with it, so its buttons stop holding back their presses for it
+    if (chord->handler->isEmpty()) {
+        m_chords.erase(chord);
+        this->updateChordButtons();
+    }
+    return ret;
+}
+
+int32_t Gamepad::onSequence(std::string listenerName, std::vector<pros::controller_digital_e_t> buttons,
+                            std::function<void(void)> func) {
+    std::vector<uint8_t> indices;
+    for (pros::controller_digital_e_t button : buttons) {
+        if (button < pros::E_CONTROLLER_DIGITAL_L1 || button > pros::E_CONTROLLER_DIGITAL_A) {
+            indices.clear();
+            break;
+        }
+        indices.push_back(button - pros::E_CONTROLLER_DIGITAL_L1);
+    }
+    if (indices.empty()) {
+        TODO("add error logging")
+        errno = EINVAL;
+        return INT32_MAX;
+    }
+    return m_sequences.add(std::move(listenerName), std::move(indices), std::move(func));
+}
+
+int32_t Gamepad::removeSequence(std::string listenerName) { return m_sequences.remove(listenerName); }
+
+void Gamepad::setSequenceTimeout(uint32_t timeout) { m_sequences.setTimeout(timeout); }
 
-        if (!m_screen_cleared && line != 3) {
-            m_controller.clear();
-            m_screen_cleared = true;
+void Gamepad::dispatchEvents() {
+    while (true) {
+        pros::c::task_notify_take(true, TIMEOUT_MAX);
+        EventRecord record;
+        while (m_event_queue.pop(record)) {
+            uint32_t latency = static_cast<uint32_t>(_impl::micros() + m_time_offset) - record.timestamp;
+            if (latency > m_max_dispatch_latency.load()) m_max_dispatch_latency = latency;
+            (this->*BUTTONS[record.button]).fire(1 << record.event);
+        }
+    }
+}
+
+int32_t Gamepad::startDispatcher(uint32_t priority) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    if (m_dispatch_task.load() != nullptr) {
+        TODO("add error logging")
+        errno = EEXIST;
+        return INT32_MAX;
+    }
+    pros::task_t task = pros::c::task_create([](void* gamepad) { static_cast<Gamepad*>(gamepad)->dispatchEvents(); },
+                                             this, priority, TASK_STACK_DEPTH_DEFAULT, "gamepad dispatcher");
+    if (task == nullptr) {
+        TODO("add error logging")
+        errno = ENOMEM;
+        return INT32_MAX;
+    }
+    m_dispatch_task = task;
+    return 0;
+}
+
+int32_t Gamepad::startSampling(uint32_t period, uint32_t priority) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    if (m_sampling_task.load() != nullptr) {
+        TODO("add error logging")
+        errno = EEXIST;
+        return INT32_MAX;
+    }
+    m_sample_period = period;
+    m_sample = m_button_state;
+    pros::task_t task = pros::c::task_create([](void* gamepad) { static_cast<Gamepad*>(gamepad)->sampleButtons(); },
+                                             this, priority, TASK_STACK_DEPTH_DEFAULT, "gamepad sampler");
+    if (task == nullptr) {
+        TODO("add error logging")
+        errno = ENOMEM;
+        return INT32_MAX;
+    }
+    m_sampling_task = task;
+    return 0;
+}
+
+uint32_t Gamepad::droppedEvents() const { return m_dropped_events.load(); }
+
+uint32_t Gamepad::maxQueuedEvents() const { return m_max_queued_events.load(); }
+
+uint32_t Gamepad::maxDispatchLatency() const { return m_max_dispatch_latency.load(); }
+
+uint32_t Gamepad::skippedEvents() const { return m_skipped_events.load(); }
+
+/**
+ * @brief Find the columns that differ between two lines, where the space past the end of a line is blank
+ *
+ * @return the first column that differs and the column after the last one that differs, or SCREEN_WIDTH for both if
+ * the lines look the same
+ */
+static std::pair<std::size_t, std::size_t> changedSpan(const ScreenLine& shown, const ScreenLine& next) {
+    auto at = [](const ScreenLine& line, std::size_t col) { return col < line.view().size() ? line.view()[col] : ' '; };
+    std::size_t first = 0;
+    std::size_t last = SCREEN_WIDTH;
+    while (first < SCREEN_WIDTH && at(shown, first) == at(next, first)) first++;
+    if (first == SCREEN_WIDTH) return {SCREEN_WIDTH, SCREEN_WIDTH};
+    while (at(shown, last - 1) == at(next, last - 1)) last--;
+    return {first, last};
+}
+
+void Gamepad::updateScreens(uint64_t now, bool connected) {
+    const uint32_t now_ms = now / 1000;
+    // Lock Mutexes for Thread Safety
+    std::lock_guard<_impl::RecursiveMutex> guard_scheduling(m_mutex);
+    this->init();
+
+    // the first update only starts the time of the screens
+    if (m_last_update_time == 0) m_last_update_time = now_ms;
+    // Update all screens, and send new button presses, also note deltatime. Time passes for the screens while the
+    // controller is disconnected too, so that an alert that runs out during a disconnect is not shown after it
+    for (const std::shared_ptr<AbstractScreen>& screen : m_screens) {
+        screen->update(now_ms - m_last_update_time);
+        screen->handleEvents(m_rising_edges);
+    }
+    m_last_update_time = now_ms;
+
+    // Disable screen writes if the controller is disconnected
+    if (!connected) {
+        if (m_screen_cleared) {
+            m_next_buffer = std::move(m_current_screen);
             m_current_screen = {};
-            m_last_print_time = pros::millis();
-            return;
+            m_screen_cleared = false;
+            m_line_scheduler.cancelAll();
         }
+        return;
+    }
 
-        // text on screen is the same as last frame's text so no use updating
-        if (m_current_screen[line] == m_next_buffer[line] && line != 3) {
-            m_next_buffer[line] = std::nullopt;
-            continue;
+    // Clear current screen on reconnect
+    if (!m_screen_cleared) {
+        m_current_screen = {};
+        // lines that were on the screen before the disconnect wait from the reconnect
+        for (uint8_t line = 0; line < 4; line++)
+            if (m_next_buffer.has(line)) m_line_scheduler.markPending(line, 0, now_ms);
+    }
+
+    // Check if enough time has passed for the Gamepad to poll for updates
+    if (now_ms - m_last_print_time <= _impl::LineScheduler::WRITE_INTERVAL) return;
+
+    for (std::size_t i = 0; i < m_screens.size(); i++) {
+        // get all lines that aren't being used by a higher priority screen
+        const uint8_t visible_lines = ~m_next_buffer.mask() & 0b1111;
+        if (visible_lines == 0) break;
+
+        // get the buffer of the next lower priority screen and set it to be printed
+        const ScreenBuffer& buffer = m_screens[i]->getScreen(visible_lines);
+        for (uint8_t j = 0; j < 4; j++) {
+            if (!buffer.has(j) || buffer[j].empty() || m_next_buffer.has(j)) continue;
+            m_next_buffer.set(j, buffer[j]);
+            m_line_scheduler.markPending(j, _impl::LineScheduler::rank(m_screens[i]->getPriority()), now_ms);
         }
+    }
 
-        // print to screen or rumble
-        if (line == 3) m_controller.rumble(m_next_buffer[line].value_or("").c_str());
-        else m_controller.set_text(line, 0, m_next_buffer[line].value_or("") + std::string(40, ' '));
-        if (line != 3) m_current_screen[line] = std::move(m_next_buffer[line]);
-        m_next_buffer[line] = std::nullopt;
-        m_last_printed_line = line;
-        m_last_print_time = pros::millis();
+    if (!m_screen_cleared && (m_next_buffer.mask() & 0b111)) {
+        // if the controller did not take the clear, it is tried again in the next write slot
+        m_screen_cleared = pros::c::controller_clear(m_id) == 1;
+        m_current_screen = {};
+        m_last_print_time = now_ms;
         return;
     }
-}
 
-void Gamepad::update() {
-    for (int i = pros::E_CONTROLLER_DIGITAL_L1; i <= pros::E_CONTROLLER_DIGITAL_A; ++i) {
-        this->updateButton(static_cast<pros::controller_digital_e_t>(i));
+    // text on screen is the same as last frame's text so no use updating
+    for (uint8_t line = 0; line < 3; line++) {
+        if (!m_next_buffer.has(line) || changedSpan(m_current_screen[line], m_next_buffer[line]).first != SCREEN_WIDTH)
+            continue;
+        m_next_buffer.clear(line);
+        m_line_scheduler.cancel(line);
     }
 
-    m_LeftX = m_controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_X) / 127.0;
-    m_LeftY = m_controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y) / 127.0;
-    m_RightX = m_controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X) / 127.0;
-    m_RightY = m_controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y) / 127.0;
+    // start from the line after the last one printed, so lines with the same score take turns
+    const uint8_t line = m_line_scheduler.pick((m_last_printed_line + 1) % 4, now_ms);
+    if (line == _impl::LineScheduler::LINE_COUNT) return;
+
+    // print to screen or rumble
+    bool sent = false;
+    if (line == 3) {
+        sent = pros::c::controller_rumble(m_id, m_next_buffer[line].c_str()) == 1;
+    } else {
+        // only send the span of columns that changed, so short writes get through the link sooner. Since the screen
+        // was cleared, any line that was never printed is blank
+        auto [first, last] = changedSpan(m_current_screen[line], m_next_buffer[line]);
+        // the controller takes a start column of at most 14, the columns in between have not changed anyway
+        first = std::min<std::size_t>(first, 14);
+        std::array<char, SCREEN_WIDTH + 1> text;
+        text.fill(' ');
+        m_next_buffer[line].view().copy(text.data(), SCREEN_WIDTH);
+        text[last] = '\0';
+        sent = pros::c::controller_set_text(m_id, line, first, text.data() + first) == 1;
+        if (sent) m_current_screen.set(line, m_next_buffer[line]);
+    }
+    // a write the controller did not take still used up the slot, and the line stays pending for the next one
+    if (sent) {
+        m_next_buffer.clear(line);
+        m_line_scheduler.written(line, now_ms);
+    }
+    m_last_printed_line = line;
+    m_last_print_time = now_ms;
+}
+
+void Gamepad::update() {
+    _impl::PhaseTimer timer(m_profile);
+    InputFrame frame;
+    if (!this->readFrame(frame)) return;
+    timer.lap(PHASE_SAMPLING);
+    // every button and screen sees the same timestamp, so all of their timing math is consistent
+    const uint64_t now = frame.timestamp;
+    const uint64_t dispatched = m_profile.ns[PHASE_DISPATCH];
+    this->updateButtons(frame);
+    this->recordEvents(now);
+    pros::task_t dispatch_task = m_dispatch_task.load();
+    if (dispatch_task != nullptr && m_event_queue.size() != 0) pros::c::task_notify(dispatch_task);
+    // dispatching happens inside the button updates, but it is timed separately
+    timer.lap(PHASE_BUTTONS, m_profile.ns[PHASE_DISPATCH] - dispatched);
+
+    InputSnapshot snapshot {
+        .timestamp = now,
+        .frame = m_frame++,
+        .buttons = m_button_state,
+        .rising_edges = m_rising_edges,
+        .falling_edges = m_falling_edges,
+    };
+    for (uint8_t i = 0; i < snapshot.axes.size(); i++) snapshot.axes[i] = frame.axes[i] / 127.0;
+    timer.lap(PHASE_AXES);
+    this->transformAxes(snapshot);
+    timer.lap(PHASE_TRANSFORM);
+    m_snapshot.store(snapshot);
+    m_history.push(now, m_button_state, m_rising_edges, frame.axes);
+    timer.lap(PHASE_AXES);
+
+    this->updateScreens(now, frame.connected);
+    timer.lap(PHASE_SCREENS);
+    if constexpr (GAMEPAD_PROFILE) m_profile.updates++;
+}
 
-    this->updateScreens();
+void Gamepad::transformAxes(InputSnapshot& snapshot) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    snapshot.transformed_axes = snapshot.axes;
+    auto transform = [&](std::optional<Transformation>& transformation, uint8_t x, uint8_t y) {
+        if (!transformation) return;
+        std::tie(snapshot.transformed_axes[x], snapshot.transformed_axes[y]) =
+            transformation->get_value({snapshot.axes[x], snapshot.axes[y]});
+        m_transform_evaluations++;
+    };
+    transform(m_left_transformation, pros::E_CONTROLLER_ANALOG_LEFT_X, pros::E_CONTROLLER_ANALOG_LEFT_Y);
+    transform(m_right_transformation, pros::E_CONTROLLER_ANALOG_RIGHT_X, pros::E_CONTROLLER_ANALOG_RIGHT_Y);
 }
 
 void Gamepad::addScreen(std::shared_ptr<AbstractScreen> screen) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
     uint32_t last = UINT32_MAX;
     uint32_t pos = 0;
     for (pos = 0; pos < m_screens.size(); pos++) {
@@ -130,26 +543,46 @@ void Gamepad::addScreen(std::shared_ptr<AbstractScreen> screen) {
     m_screens.emplace(m_screens.begin() + pos, screen);
 }
 
-int32_t Gamepad::printLine(uint8_t line, std::string str) { return m_default_screen->printLine(line, str); }
+int32_t Gamepad::printLine(uint8_t line, std::string_view str) { return this->defaultScreen().printLine(line, str); }
 
-void Gamepad::clear() { m_default_screen->printLine(0, " \n \n "); }
+void Gamepad::clear() { this->defaultScreen().printLine(0, " \n \n "); }
 
-int32_t Gamepad::clear(uint8_t line) { return m_default_screen->printLine(line, " "); }
+int32_t Gamepad::clear(uint8_t line) { return this->defaultScreen().printLine(line, " "); }
 
-void Gamepad::rumble(std::string rumble_pattern) { m_default_screen->rumble(rumble_pattern); }
+void Gamepad::rumble(std::string_view rumble_pattern) { this->defaultScreen().rumble(rumble_pattern); }
+
+int32_t Gamepad::setLineDeadline(uint8_t line, uint32_t deadline) {
+    if (line > 3) {
+        TODO("add error logging")
+        errno = EINVAL;
+        return INT32_MAX;
+    }
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    m_line_scheduler.setDeadline(line, deadline);
+    return 0;
+}
+
+LineStats Gamepad::lineStats(uint8_t line) const {
+    if (line > 3) return {};
+    return m_line_scheduler.stats(line);
+}
 
 const Button& Gamepad::operator[](pros::controller_digital_e_t button) { return this->*Gamepad::buttonToPtr(button); }
 
 float Gamepad::operator[](pros::controller_analog_e_t axis) {
     switch (axis) {
-        case pros::E_CONTROLLER_ANALOG_LEFT_X: return m_LeftX;
-        case pros::E_CONTROLLER_ANALOG_LEFT_Y: return m_LeftY;
-        case pros::E_CONTROLLER_ANALOG_RIGHT_X: return m_RightX;
-        case pros::E_CONTROLLER_ANALOG_RIGHT_Y: return m_RightY;
+        case pros::E_CONTROLLER_ANALOG_LEFT_X:
+        case pros::E_CONTROLLER_ANALOG_LEFT_Y:
+        case pros::E_CONTROLLER_ANALOG_RIGHT_X:
+        case pros::E_CONTROLLER_ANALOG_RIGHT_Y: return m_snapshot.load().axes[axis];
         default: TODO("add error logging") return 0;
     }
 }
 
+InputSnapshot Gamepad::snapshot() const { return m_snapshot.load(); }
+
+const InputHistory<GAMEPAD_HISTORY_SIZE>& Gamepad::history() const { return m_history; }
+
 const Button& Gamepad::buttonL1() { return m_L1; }
 
 const Button& Gamepad::buttonL2() { return m_L2; }
@@ -175,53 +608,66 @@ const Button& Gamepad::buttonY() { return m_Y; }
 const Button& Gamepad::buttonA() { return m_A; }
 
 float Gamepad::axisLeftX(bool use_curve) {
-    if (use_curve && m_left_transformation) return m_left_transformation->get_value({m_LeftX, m_LeftY}).first;
-    else return m_LeftX;
+    const InputSnapshot snapshot = m_snapshot.load();
+    if (use_curve) return snapshot.transformed_axes[pros::E_CONTROLLER_ANALOG_LEFT_X];
+    else return snapshot.axes[pros::E_CONTROLLER_ANALOG_LEFT_X];
 }
 
 float Gamepad::axisLeftY(bool use_curve) {
-    if (use_curve && m_left_transformation) return m_left_transformation->get_value({m_LeftX, m_LeftY}).second;
-    else return m_LeftY;
+    const InputSnapshot snapshot = m_snapshot.load();
+    if (use_curve) return snapshot.transformed_axes[pros::E_CONTROLLER_ANALOG_LEFT_Y];
+    else return snapshot.axes[pros::E_CONTROLLER_ANALOG_LEFT_Y];
 }
 
 float Gamepad::axisRightX(bool use_curve) {
-    if (use_curve && m_right_transformation) return m_right_transformation->get_value({m_RightX, m_RightY}).first;
-    else return m_RightX;
+    const InputSnapshot snapshot = m_snapshot.load();
+    if (use_curve) return snapshot.transformed_axes[pros::E_CONTROLLER_ANALOG_RIGHT_X];
+    else return snapshot.axes[pros::E_CONTROLLER_ANALOG_RIGHT_X];
 }
 
 float Gamepad::axisRightY(bool use_curve) {
-    if (use_curve && m_right_transformation) return m_right_transformation->get_value({m_RightX, m_RightY}).second;
-    else return m_RightY;
+    const InputSnapshot snapshot = m_snapshot.load();
+    if (use_curve) return snapshot.transformed_axes[pros::E_CONTROLLER_ANALOG_RIGHT_Y];
+    else return snapshot.axes[pros::E_CONTROLLER_ANALOG_RIGHT_Y];
+}
+
+void Gamepad::setInputSource(std::shared_ptr<InputSource> source) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    m_source = std::move(source);
+    m_source_changed = true;
+}
+
+void Gamepad::setInputSink(std::shared_ptr<InputSink> sink) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    m_sink = std::move(sink);
 }
 
 void Gamepad::set_left_transform(Transformation left_transformation) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
     m_left_transformation = std::move(left_transformation);
 }
 
 void Gamepad::set_right_transform(Transformation right_transformation) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
     m_right_transformation = std::move(right_transformation);
 }
 
+uint32_t Gamepad::transformEvaluations() const { return m_transform_evaluations.load(); }
+
+UpdateProfile Gamepad::profile() const { return m_profile; }
+
+void Gamepad::resetProfile() { m_profile = {}; }
+
 std::string Gamepad::uniqueName() {
     static std::atomic<uint32_t> i = 0;
     return std::to_string(i++) + "_internal";
 }
 
 Button Gamepad::* Gamepad::buttonToPtr(pros::controller_digital_e_t button) {
-    switch (button) {
-        case pros::E_CONTROLLER_DIGITAL_L1: return &Gamepad::m_L1;
-        case pros::E_CONTROLLER_DIGITAL_L2: return &Gamepad::m_L2;
-        case pros::E_CONTROLLER_DIGITAL_R1: return &Gamepad::m_R1;
-        case pros::E_CONTROLLER_DIGITAL_R2: return &Gamepad::m_R2;
-        case pros::E_CONTROLLER_DIGITAL_UP: return &Gamepad::m_Up;
-        case pros::E_CONTROLLER_DIGITAL_DOWN: return &Gamepad::m_Down;
-        case pros::E_CONTROLLER_DIGITAL_LEFT: return &Gamepad::m_Left;
-        case pros::E_CONTROLLER_DIGITAL_RIGHT: return &Gamepad::m_Right;
-        case pros::E_CONTROLLER_DIGITAL_X: return &Gamepad::m_X;
-        case pros::E_CONTROLLER_DIGITAL_B: return &Gamepad::m_B;
-        case pros::E_CONTROLLER_DIGITAL_Y: return &Gamepad::m_Y;
-        case pros::E_CONTROLLER_DIGITAL_A: return &Gamepad::m_A;
-        default: TODO("add error logging") return &Gamepad::Fake;
+    if (button >= pros::E_CONTROLLER_DIGITAL_L1 && button <= pros::E_CONTROLLER_DIGITAL_A) {
+        return BUTTONS[button - pros::E_CONTROLLER_DIGITAL_L1];
     }
+    TODO("add error logging")
+    return &Gamepad::Fake;
 }
 } // namespace gamepad
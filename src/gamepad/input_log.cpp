@@ -0,0 +1,502 @@
+#include "gamepad/input_log.hpp"
+#include "gamepad/todo.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gamepad {
+namespace {
+constexpr char MAGIC[4] = {'G', 'P', 'I', 'L'};
+constexpr char INDEX_MAGIC[4] = {'G', 'P', 'I', 'X'};
+/// Version 2 added the events a button fired. Version 1 logs never have any, so they are read the same way
+constexpr uint8_t VERSION = 2;
+constexpr uint8_t OLDEST_VERSION = 1;
+/// The magic, the version, 3 reserved bytes, and the keyframe interval in ms
+constexpr std::size_t HEADER_SIZE = 12;
+/// The offset of the index, the number of index entries, and the index magic
+constexpr std::size_t TRAILER_SIZE = 12;
+/// The timestamp and the offset of a keyframe
+constexpr std::size_t INDEX_ENTRY_SIZE = 12;
+/// The most bytes a single frame can be encoded into
+constexpr std::size_t MAX_FRAME_SIZE = 1 + 10 + 3 + 3 + 4 * 2;
+
+/// The frame stores every field, instead of only the changes since the previous frame
+constexpr uint8_t TAG_KEYFRAME = 1 << 0;
+/// The buttons changed, and the changed buttons follow (in a keyframe, every button that is held follows)
+constexpr uint8_t TAG_BUTTONS = 1 << 1;
+/// Some buttons were toggled since the previous frame, and the toggled buttons follow
+constexpr uint8_t TAG_TOGGLED = 1 << 2;
+/// The controller is connected
+constexpr uint8_t TAG_CONNECTED = 1 << 3;
+
+/// A keyframe always stores the buttons, so a keyframe tag without TAG_BUTTONS marks the events a button fired
+constexpr uint8_t TAG_EVENTS = TAG_KEYFRAME;
+
+/// An axis changed, and the change follows (the highest 4 bits of the tag are one per axis)
+constexpr uint8_t tagAxis(std::size_t axis) { return 1 << (4 + axis); }
+
+void putVarint(std::vector<uint8_t>& buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t* data, std::size_t end, std::size_t& position, uint64_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 64 && position < end; shift += 7) {
+        uint8_t byte = data[position++];
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+/// Maps small negative and positive numbers to small unsigned numbers, so they fit in fewer varint bytes
+uint32_t zigzag(int32_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+
+int32_t unzigzag(uint32_t value) { return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1); }
+
+void putFixed(std::vector<uint8_t>& buffer, uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; i++) buffer.push_back(value >> (8 * i));
+}
+
+uint64_t getFixed(const uint8_t* data, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; i++) value |= uint64_t(data[i]) << (8 * i);
+    return value;
+}
+} // namespace
+
+InputLogWriter::InputLogWriter(uint32_t keyframe_interval, std::size_t capacity, std::size_t max_keyframes)
+    : m_capacity(std::max(capacity, MAX_FRAME_SIZE)),
+      m_keyframe_interval(std::max<uint64_t>(keyframe_interval, 1) * 1000) {
+    for (std::vector<uint8_t>& buffer : m_buffers) buffer.reserve(std::max(m_capacity, HEADER_SIZE));
+    // the index never grows past this, so record() never allocates
+    m_index.reserve(std::max<std::size_t>(max_keyframes, 1));
+}
+
+InputLogWriter::~InputLogWriter() {
+    if (m_file != nullptr) this->close();
+}
+
+int32_t InputLogWriter::open(const char* path) {
+    if (m_file != nullptr) {
+        TODO("add error logging")
+        errno = EEXIST;
+        return INT32_MAX;
+    }
+    m_file = std::fopen(path, "wb");
+    if (m_file == nullptr) {
+        TODO("add error logging")
+        errno = EIO;
+        return INT32_MAX;
+    }
+    // the buffers are already large, so the file doesn't need another one that every write is copied through
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+    for (std::vector<uint8_t>& buffer : m_buffers) buffer.clear();
+    m_active = 0;
+    m_full = -1;
+    std::vector<uint8_t>& buffer = m_buffers[m_active];
+    buffer.insert(buffer.end(), std::begin(MAGIC), std::end(MAGIC));
+    putFixed(buffer, VERSION, 4);
+    putFixed(buffer, m_keyframe_interval / 1000, 4);
+    m_offset = buffer.size();
+    m_written = 0;
+    m_need_keyframe = true;
+    m_index.clear();
+    m_closing = false;
+    m_write_failed = false;
+    return this->flush();
+}
+
+int32_t InputLogWriter::startFlushing(uint32_t priority) {
+    if (m_file == nullptr) {
+        TODO("add error logging")
+        errno = EBADF;
+        return INT32_MAX;
+    }
+    if (m_flush_task.load() != nullptr) {
+        TODO("add error logging")
+        errno = EEXIST;
+        return INT32_MAX;
+    }
+    m_flush_task_done = false;
+    pros::task_t task = pros::c::task_create([](void* writer) { static_cast<InputLogWriter*>(writer)->flushBuffers(); },
+                                             this, priority, TASK_STACK_DEPTH_DEFAULT, "gamepad log flusher");
+    if (task == nullptr) {
+        TODO("add error logging")
+        errno = ENOMEM;
+        return INT32_MAX;
+    }
+    m_flush_task = task;
+    return 0;
+}
+
+void InputLogWriter::flushBuffers() {
+    while (!m_closing.load()) {
+        pros::c::task_notify_take(true, TIMEOUT_MAX);
+        if (!this->writeFull()) m_write_failed = true;
+    }
+    m_flush_task_done = true;
+    pros::c::task_notify(m_closing_task.load());
+}
+
+void InputLogWriter::record(const InputFrame& frame) {
+    if (m_file == nullptr) return;
+    if (!this->reserve()) {
+        m_dropped_frames++;
+        // the frames after a dropped frame can't be deltas of it
+        m_need_keyframe = true;
+        return;
+    }
+    bool keyframe = m_need_keyframe || frame.timestamp >= m_next_keyframe;
+    uint32_t offset = m_offset;
+    this->encode(frame, keyframe);
+    if (keyframe) {
+        if (m_index.size() < m_index.capacity()) m_index.push_back({frame.timestamp, offset});
+        // keyframes are written at fixed times after the first one
+        uint64_t first = m_index.front().timestamp;
+        m_next_keyframe = first + ((frame.timestamp - first) / m_keyframe_interval + 1) * m_keyframe_interval;
+        m_need_keyframe = false;
+    }
+    m_previous = frame;
+}
+
+void InputLogWriter::recordEvents(uint64_t timestamp, pros::controller_digital_e_t button, uint8_t events) {
+    if (m_file == nullptr) return;
+    // events are stored relative to the frame before them, so they are dropped along with it
+    if (m_need_keyframe || !this->reserve()) {
+        m_dropped_events += std::popcount(events);
+        return;
+    }
+    std::vector<uint8_t>& buffer = m_buffers[m_active];
+    const std::size_t start = buffer.size();
+    buffer.push_back(TAG_EVENTS);
+    putVarint(buffer, timestamp > m_previous.timestamp ? timestamp - m_previous.timestamp : 0);
+    buffer.push_back(button - pros::E_CONTROLLER_DIGITAL_L1);
+    buffer.push_back(events);
+    m_offset += buffer.size() - start;
+}
+
+void InputLogWriter::encode(const InputFrame& frame, bool keyframe) {
+    std::vector<uint8_t>& buffer = m_buffers[m_active];
+    const std::size_t start = buffer.size();
+    uint8_t tag = frame.connected ? TAG_CONNECTED : 0;
+    buffer.push_back(0);
+
+    if (keyframe) {
+        tag |= TAG_KEYFRAME | TAG_BUTTONS;
+        putVarint(buffer, frame.timestamp);
+        putVarint(buffer, frame.buttons);
+    } else {
+        putVarint(buffer, frame.timestamp - m_previous.timestamp);
+        if (frame.buttons != m_previous.buttons) {
+            tag |= TAG_BUTTONS;
+            putVarint(buffer, frame.buttons ^ m_previous.buttons);
+        }
+    }
+    if (frame.toggled != 0) {
+        tag |= TAG_TOGGLED;
+        putVarint(buffer, frame.toggled);
+    }
+    for (std::size_t i = 0; i < frame.axes.size(); i++) {
+        if (keyframe) {
+            buffer.push_back(static_cast<uint8_t>(frame.axes[i]));
+        } else if (frame.axes[i] != m_previous.axes[i]) {
+            tag |= tagAxis(i);
+            putVarint(buffer, zigzag(frame.axes[i] - m_previous.axes[i]));
+        }
+    }
+    buffer[start] = tag;
+    m_offset += buffer.size() - start;
+}
+
+bool InputLogWriter::reserve() {
+    if (m_capacity - std::min(m_capacity, m_buffers[m_active].size()) >= MAX_FRAME_SIZE) return true;
+    return this->handOff();
+}
+
+bool InputLogWriter::handOff() {
+    if (m_buffers[m_active].empty()) return true;
+    if (m_full.load() != -1) return false;
+    // the other buffer was emptied before it was released, so records can be encoded into it right away
+    m_full = m_active;
+    m_active ^= 1;
+    pros::task_t task = m_flush_task.load();
+    if (task != nullptr) pros::c::task_notify(task);
+    return true;
+}
+
+bool InputLogWriter::writeFull() {
+    const int8_t full = m_full.load();
+    if (full == -1) return true;
+    std::vector<uint8_t>& buffer = m_buffers[full];
+    const bool written = std::fwrite(buffer.data(), 1, buffer.size(), m_file) == buffer.size();
+    m_written += buffer.size();
+    buffer.clear();
+    m_full = -1;
+    return written;
+}
+
+int32_t InputLogWriter::flush() {
+    if (m_file == nullptr) {
+        TODO("add error logging")
+        errno = EBADF;
+        return INT32_MAX;
+    }
+    if (m_flush_task.load() != nullptr) {
+        // if the flush task is still writing the other buffer, this one is handed off once it fills up instead
+        this->handOff();
+        return 0;
+    }
+    bool written = this->writeFull();
+    if (!this->handOff() || !this->writeFull() || !written) {
+        TODO("add error logging")
+        errno = EIO;
+        return INT32_MAX;
+    }
+    return 0;
+}
+
+int32_t InputLogWriter::close() {
+    if (m_file == nullptr) {
+        TODO("add error logging")
+        errno = EBADF;
+        return INT32_MAX;
+    }
+    pros::task_t task = m_flush_task.load();
+    if (task != nullptr) {
+        // the flush task notifies this task once it has written its last buffer
+        m_closing_task = pros::c::task_get_current();
+        m_closing = true;
+        pros::c::task_notify(task);
+        while (!m_flush_task_done.load()) pros::c::task_notify_take(true, TIMEOUT_MAX);
+        m_flush_task = nullptr;
+    }
+    bool written = this->flush() == 0;
+
+    const uint32_t index_offset = m_offset;
+    for (const IndexEntry& entry : m_index) {
+        putFixed(m_buffers[m_active], entry.timestamp, 8);
+        putFixed(m_buffers[m_active], entry.offset, 4);
+        if (m_buffers[m_active].size() + INDEX_ENTRY_SIZE + TRAILER_SIZE > m_capacity) {
+            written = this->flush() == 0 && written;
+        }
+    }
+    std::vector<uint8_t>& buffer = m_buffers[m_active];
+    putFixed(buffer, index_offset, 4);
+    putFixed(buffer, m_index.size(), 4);
+    buffer.insert(buffer.end(), std::begin(INDEX_MAGIC), std::end(INDEX_MAGIC));
+    written = this->flush() == 0 && written;
+
+    std::fclose(m_file);
+    m_file = nullptr;
+    if (!written || m_write_failed.load()) {
+        TODO("add error logging")
+        errno = EIO;
+        return INT32_MAX;
+    }
+    return 0;
+}
+
+std::size_t InputLogWriter::bufferedBytes() const { return m_offset - m_written.load(); }
+
+uint32_t InputLogWriter::droppedFrames() const { return m_dropped_frames.load(); }
+
+uint32_t InputLogWriter::droppedEvents() const { return m_dropped_events.load(); }
+
+InputLogReader::~InputLogReader() {
+#if defined(__linux__)
+    if (m_mapped) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+}
+
+int32_t InputLogReader::open(const char* path) {
+    if (m_data != nullptr) {
+        TODO("add error logging")
+        errno = EEXIST;
+        return INT32_MAX;
+    }
+#if defined(__linux__)
+    int fd = ::open(path, O_RDONLY);
+    struct stat info {};
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        if (fd >= 0) ::close(fd);
+        TODO("add error logging")
+        errno = EIO;
+        return INT32_MAX;
+    }
+    m_size = info.st_size;
+    void* mapping = m_size == 0 ? MAP_FAILED : mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping != MAP_FAILED) {
+        m_data = static_cast<const uint8_t*>(mapping);
+        m_mapped = true;
+    }
+#else
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        TODO("add error logging")
+        errno = EIO;
+        return INT32_MAX;
+    }
+    uint8_t chunk[512];
+    for (std::size_t read; (read = std::fread(chunk, 1, sizeof(chunk), file)) != 0;) {
+        m_contents.insert(m_contents.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+    m_data = m_contents.data();
+    m_size = m_contents.size();
+#endif
+    if (m_data == nullptr || m_size < HEADER_SIZE || std::memcmp(m_data, MAGIC, sizeof(MAGIC)) != 0 ||
+        m_data[4] < OLDEST_VERSION || m_data[4] > VERSION) {
+#if defined(__linux__)
+        if (m_mapped) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_mapped = false;
+        m_contents.clear();
+        TODO("add error logging")
+        errno = EINVAL;
+        return INT32_MAX;
+    }
+    m_end = m_size;
+    this->readIndex();
+
+    // the last frame is only known by decoding up to it, from the last keyframe in the index if there is one
+    m_position = m_index_count == 0 ? HEADER_SIZE : getFixed(this->indexEntry(m_index_count - 1) + 8, 4);
+    m_previous = {};
+    InputFrame frame;
+    while (this->decode(frame)) m_end_time = frame.timestamp;
+
+    m_position = HEADER_SIZE;
+    m_previous = {};
+    m_events.clear();
+    return 0;
+}
+
+void InputLogReader::readIndex() {
+    if (m_size < HEADER_SIZE + TRAILER_SIZE) return;
+    const uint8_t* trailer = m_data + m_size - TRAILER_SIZE;
+    if (std::memcmp(trailer + 8, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) return;
+    uint64_t offset = getFixed(trailer, 4);
+    uint64_t count = getFixed(trailer + 4, 4);
+    if (offset < HEADER_SIZE || offset + count * INDEX_ENTRY_SIZE != m_size - TRAILER_SIZE) return;
+    m_end = offset;
+    m_index = offset;
+    m_index_count = count;
+}
+
+bool InputLogReader::decode(InputFrame& frame) {
+    if (m_position >= m_end) return false;
+    std::size_t position = m_position;
+    uint8_t tag = m_data[position++];
+    frame = m_previous;
+    frame.connected = tag & TAG_CONNECTED;
+    frame.toggled = 0;
+
+    uint64_t value;
+    bool valid = getVarint(m_data, m_end, position, value);
+    frame.timestamp = (tag & TAG_KEYFRAME) ? value : frame.timestamp + value;
+    if (valid && (tag & TAG_BUTTONS)) {
+        valid = getVarint(m_data, m_end, position, value);
+        frame.buttons = (tag & TAG_KEYFRAME) ? value : frame.buttons ^ value;
+    }
+    if (valid && (tag & TAG_TOGGLED)) {
+        valid = getVarint(m_data, m_end, position, value);
+        frame.toggled = value;
+    }
+    for (std::size_t i = 0; valid && i < frame.axes.size(); i++) {
+        if (tag & TAG_KEYFRAME) {
+            valid = position < m_end;
+            if (valid) frame.axes[i] = static_cast<int8_t>(m_data[position++]);
+        } else if (tag & tagAxis(i)) {
+            valid = getVarint(m_data, m_end, position, value);
+            frame.axes[i] += unzigzag(value);
+        }
+    }
+    // a truncated frame, such as the last one of a log that was never closed, ends the log
+    if (!valid) {
+        m_position = m_end;
+        return false;
+    }
+    m_position = position;
+    m_previous = frame;
+
+    // the events the frame fired follow it, as the time since the frame, the button, and the events
+    m_events.clear();
+    while (m_position < m_end && (m_data[m_position] & (TAG_KEYFRAME | TAG_BUTTONS)) == TAG_EVENTS) {
+        position = m_position + 1;
+        if (!getVarint(m_data, m_end, position, value) || position + 2 > m_end) {
+            m_position = m_end;
+            break;
+        }
+        auto button = static_cast<pros::controller_digital_e_t>(pros::E_CONTROLLER_DIGITAL_L1 + m_data[position]);
+        m_events.push_back({frame.timestamp + value, button, m_data[position + 1]});
+        m_position = position + 2;
+    }
+    return true;
+}
+
+bool InputLogReader::read(InputFrame& frame) {
+    if (m_has_pending) {
+        frame = m_pending;
+        m_has_pending = false;
+        return true;
+    }
+    return this->decode(frame);
+}
+
+const std::vector<LoggedEvents>& InputLogReader::events() const { return m_events; }
+
+int32_t InputLogReader::seek(uint64_t timestamp) {
+    if (m_data == nullptr) {
+        TODO("add error logging")
+        errno = EBADF;
+        return INT32_MAX;
+    }
+    m_has_pending = false;
+    m_previous = {};
+    m_position = HEADER_SIZE;
+    if (m_index_count != 0) {
+        // find the last keyframe at or before the time, or the first one if there is none
+        std::size_t low = 0, high = m_index_count;
+        while (high - low > 1) {
+            std::size_t middle = low + (high - low) / 2;
+            if (getFixed(this->indexEntry(middle), 8) <= timestamp) low = middle;
+            else high = middle;
+        }
+        m_position = getFixed(this->indexEntry(low) + 8, 4);
+    }
+    while (this->decode(m_pending)) {
+        if (m_pending.timestamp >= timestamp) {
+            m_has_pending = true;
+            break;
+        }
+    }
+    return 0;
+}
+
+const uint8_t* InputLogReader::indexEntry(std::size_t i) const { return m_data + m_index + i * INDEX_ENTRY_SIZE; }
+
+uint64_t InputLogReader::startTime() const {
+    if (m_index_count != 0) return getFixed(this->indexEntry(0), 8);
+    // without an index, the first frame is still always a keyframe with an absolute time
+    std::size_t position = HEADER_SIZE + 1;
+    uint64_t timestamp = 0;
+    if (m_data != nullptr) getVarint(m_data, m_end, position, timestamp);
+    return timestamp;
+}
+
+uint64_t InputLogReader::endTime() const { return m_end_time; }
+} // namespace gamepad
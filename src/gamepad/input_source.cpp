@@ -0,0 +1,27 @@
+#include "gamepad/input_source.hpp"
+#include <utility>
+
+namespace gamepad {
+InputRecorder::InputRecorder(std::size_t capacity) { m_frames.reserve(capacity); }
+
+void InputRecorder::record(const InputFrame& frame) {
+    // never grow the vector, so recording a frame never allocates
+    if (m_frames.size() == m_frames.capacity()) m_dropped_frames++;
+    else m_frames.push_back(frame);
+}
+
+const std::vector<InputFrame>& InputRecorder::frames() const { return m_frames; }
+
+uint32_t InputRecorder::droppedFrames() const { return m_dropped_frames; }
+
+ReplaySource::ReplaySource(std::vector<InputFrame> frames)
+    : m_frames(std::move(frames)) {}
+
+bool ReplaySource::read(InputFrame& frame) {
+    if (this->finished()) return false;
+    frame = m_frames[m_next++];
+    return true;
+}
+
+bool ReplaySource::finished() const { return m_next >= m_frames.size(); }
+} // namespace gamepad
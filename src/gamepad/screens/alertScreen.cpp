@@ -10,27 +10,27 @@
 
 namespace gamepad {
 
-ScreenBuffer AlertScreen::getScreen(std::set<uint8_t> visible_lines) {
-    std::lock_guard<pros::Mutex> guard(m_mutex);
+const ScreenBuffer& AlertScreen::getScreen(uint8_t visible_lines) {
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
     if (m_screen_contents.has_value()) {
-        m_screen_contents->screen.at(3) = std::nullopt;
+        m_screen_contents->screen.clear(3);
         return m_screen_contents->screen;
     }
-    if (m_screen_buffer.size() < 1) return ScreenBuffer();
+    if (m_screen_buffer.size() < 1) return EMPTY_BUFFER;
 
-    for (uint8_t i = 0; i < 4; i++) {
-        if (!m_screen_buffer[0].screen[i].has_value()) continue;
-        if (m_screen_buffer[0].screen[i].has_value() && !visible_lines.contains(i)) return ScreenBuffer();
-    }
+    // the whole alert has to fit, or none of it is shown
+    if (m_screen_buffer[0].screen.mask() & ~visible_lines) return EMPTY_BUFFER;
     m_screen_contents = std::move(m_screen_buffer[0]);
     m_screen_buffer.pop_front();
-    m_line_set_time = pros::millis();
+    m_time_shown = 0;
     return m_screen_contents->screen;
 }
 
 void AlertScreen::update(uint32_t delta_time) {
-    std::lock_guard<pros::Mutex> guard(m_mutex);
-    if (pros::millis() - m_line_set_time >= m_screen_contents->duration) m_screen_contents = std::nullopt;
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    if (!m_screen_contents.has_value()) return;
+    m_time_shown += delta_time;
+    if (m_time_shown >= m_screen_contents->duration) m_screen_contents = std::nullopt;
 }
 
 int32_t AlertScreen::addAlerts(uint8_t line, std::string str, uint32_t duration, std::string rumble) {
@@ -57,12 +57,12 @@ int32_t AlertScreen::addAlerts(uint8_t line, std::string str, uint32_t duration,
 
     ScreenBuffer buffer;
 
-    if (strs[0] != "") buffer[0] = std::move(strs[0]);
-    if (strs[1] != "") buffer[1] = std::move(strs[1]);
-    if (strs[2] != "") buffer[2] = std::move(strs[2]);
-    if (rumble != "") buffer[3] = std::move(rumble);
+    if (strs[0] != "") buffer.set(0, strs[0]);
+    if (strs[1] != "") buffer.set(1, strs[1]);
+    if (strs[2] != "") buffer.set(2, strs[2]);
+    if (rumble != "") buffer.set(3, rumble);
 
-    std::lock_guard<pros::Mutex> guard(m_mutex);
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
     m_screen_buffer.push_back({buffer, duration});
     return ret_val;
 }
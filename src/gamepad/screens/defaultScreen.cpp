@@ -6,23 +6,23 @@
 #include <cstdint>
 #include <cstdio>
 #include <mutex>
-#include <optional>
-#include <sstream>
+#include <string_view>
 
 namespace gamepad {
 
-ScreenBuffer DefaultScreen::getScreen(std::set<uint8_t> visible_lines) {
-    ScreenBuffer output;
-    const std::lock_guard<pros::Mutex> guard(m_mutex);
+const ScreenBuffer& DefaultScreen::getScreen(uint8_t visible_lines) {
+    const std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    m_output.clear();
 
-    for (auto i = visible_lines.begin(); i != visible_lines.end(); ++i) {
-        output[*i] = std::move(m_current_buffer[*i]);
-        m_current_buffer[*i] = std::nullopt;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (!(visible_lines & (1 << i)) || !m_current_buffer.has(i)) continue;
+        m_output.set(i, m_current_buffer[i]);
+        m_current_buffer.clear(i);
     }
-    return output;
+    return m_output;
 }
 
-int32_t DefaultScreen::printLine(uint8_t line, std::string str) {
+int32_t DefaultScreen::printLine(uint8_t line, std::string_view str) {
     int32_t ret_val = 0;
     if (line > 2) {
         TODO("add error logging")
@@ -30,49 +30,48 @@ int32_t DefaultScreen::printLine(uint8_t line, std::string str) {
         return INT32_MAX;
     }
 
-    const std::lock_guard<pros::Mutex> guard(m_mutex);
+    const std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
 
-    if (str.find('\n') != std::string::npos) {
+    if (str.find('\n') != std::string_view::npos) {
         if (std::ranges::count(str, '\n') > 2) {
             TODO("add warn logging for too many lines")
             errno = EMSGSIZE;
             ret_val = INT32_MAX;
         }
 
-        std::vector<std::string> strs(3);
-        std::stringstream ss(str);
-
-        for (int i = line; i < 3; i++) {
-            if (!std::getline(ss, strs[i], '\n')) break;
-        }
-
-        for (uint8_t l = 0; l < 3; l++) {
-            if (!strs[l].empty()) m_current_buffer[l] = (strs[l]);
+        // split the string by newlines, without copying it
+        for (uint8_t l = line; l < 3; l++) {
+            const std::size_t end = str.find('\n');
+            // an empty segment, such as after a trailing newline, leaves its line alone
+            const std::string_view segment = str.substr(0, end);
+            if (!segment.empty()) m_current_buffer.set(l, segment);
+            if (end == std::string_view::npos) break;
+            str.remove_prefix(end + 1);
         }
         return ret_val;
     }
 
-    m_current_buffer[line] = std::move(str);
+    m_current_buffer.set(line, str);
     return ret_val;
 }
 
-int32_t DefaultScreen::rumble(std::string rumble_pattern) {
+int32_t DefaultScreen::rumble(std::string_view rumble_pattern) {
     int32_t ret_val = 0;
     if (rumble_pattern.size() > 8) {
         TODO("add error logging")
         errno = EMSGSIZE;
         ret_val = INT32_MAX;
-        rumble_pattern.resize(8);
+        rumble_pattern = rumble_pattern.substr(0, 8);
     }
 
-    if (rumble_pattern.find_first_not_of(".- ") != std::string::npos) {
+    if (rumble_pattern.find_first_not_of(".- ") != std::string_view::npos) {
         TODO("add error logging")
         errno = EINVAL;
         return INT32_MAX;
     }
 
-    std::lock_guard<pros::Mutex> guard(m_mutex);
-    m_current_buffer[3] = std::move(rumble_pattern);
+    std::lock_guard<_impl::RecursiveMutex> guard(m_mutex);
+    m_current_buffer.set(3, rumble_pattern);
     return ret_val;
 }
 
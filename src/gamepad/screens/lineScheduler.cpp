@@ -0,0 +1,55 @@
+#include "gamepad/screens/lineScheduler.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace gamepad::_impl {
+
+void LineScheduler::setDeadline(uint8_t line, uint32_t deadline) { m_deadline[line] = deadline; }
+
+void LineScheduler::markPending(uint8_t line, uint32_t rank, uint32_t now) {
+    if (m_pending & (1 << line)) return;
+    m_pending |= 1 << line;
+    m_pending_since[line] = now;
+    m_rank[line] = rank;
+}
+
+void LineScheduler::cancel(uint8_t line) { m_pending &= ~(1 << line); }
+
+void LineScheduler::cancelAll() { m_pending = 0; }
+
+uint8_t LineScheduler::pick(uint8_t start, uint32_t now) const {
+    // urgent lines get a bonus that no amount of waiting can reach
+    constexpr uint64_t URGENT = uint64_t(1) << 32;
+
+    uint8_t best = LINE_COUNT;
+    uint64_t best_score = 0;
+    for (uint8_t i = 0; i < LINE_COUNT; i++) {
+        const uint8_t line = (start + i) % LINE_COUNT;
+        if (!(m_pending & (1 << line))) continue;
+
+        const uint32_t wait = now - m_pending_since[line];
+        uint64_t score = uint64_t(wait) + uint64_t(m_rank[line]) * WRITE_INTERVAL;
+        if (m_deadline[line] != 0 && wait + WRITE_INTERVAL > m_deadline[line]) score += URGENT;
+
+        // only a strictly higher score wins, so ties go to the line closest after start
+        if (best == LINE_COUNT || score > best_score) {
+            best = line;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+void LineScheduler::written(uint8_t line, uint32_t now) {
+    const uint32_t wait = (m_pending & (1 << line)) ? now - m_pending_since[line] : 0;
+    m_pending &= ~(1 << line);
+
+    LineStats& stats = m_stats[line];
+    stats.writes++;
+    stats.last = wait;
+    stats.max = std::max(stats.max, wait);
+    stats.total += wait;
+    if (m_deadline[line] != 0 && wait > m_deadline[line]) stats.missed_deadlines++;
+}
+
+} // namespace gamepad::_impl
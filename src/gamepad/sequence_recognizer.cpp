@@ -0,0 +1,109 @@
+#include "gamepad/sequence_recognizer.hpp"
+#include "gamepad/todo.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+
+namespace gamepad::_impl {
+int32_t SequenceRecognizer::add(std::string name, std::vector<uint8_t> buttons, InplaceFunction<void()> func) {
+    std::lock_guard lock(m_mutex);
+    for (const auto& sequence : m_sequences) {
+        if (sequence && sequence->name == name) {
+            TODO("add error logging")
+            errno = EEXIST;
+            return INT32_MAX;
+        }
+    }
+    // every button of every sequence can add a state to the automaton, on top of the start state
+    if (1 + m_length + buttons.size() > MAX_STATES) {
+        TODO("add error logging")
+        errno = E2BIG;
+        return INT32_MAX;
+    }
+    ListenerHandle handle = m_listeners.addListener(std::move(func));
+    if (!handle.isValid()) {
+        TODO("add error logging")
+        errno = ENOMEM;
+        return INT32_MAX;
+    }
+    m_length += buttons.size();
+    m_sequences[handle.slot] = Sequence {std::move(name), std::move(buttons), handle};
+    this->compile();
+    return 0;
+}
+
+int32_t SequenceRecognizer::remove(const std::string& name) {
+    std::lock_guard lock(m_mutex);
+    auto i = std::find_if(m_sequences.begin(), m_sequences.end(),
+                          [&name](const auto& sequence) { return sequence && sequence->name == name; });
+    if (i == m_sequences.end()) return INT32_MAX;
+    m_listeners.removeListener((*i)->handle);
+    m_length -= (*i)->buttons.size();
+    i->reset();
+    this->compile();
+    return 0;
+}
+
+void SequenceRecognizer::setTimeout(uint32_t timeout) {
+    std::lock_guard lock(m_mutex);
+    m_timeout = timeout;
+}
+
+void SequenceRecognizer::compile() {
+    // build a trie of every sequence, where state 0 is the start
+    m_transitions.assign(1, {});
+    m_outputs.assign(1, 0);
+    for (const auto& sequence : m_sequences) {
+        if (!sequence) continue;
+        uint16_t state = 0;
+        for (uint8_t button : sequence->buttons) {
+            if (m_transitions[state][button] == 0) {
+                m_transitions[state][button] = m_transitions.size();
+                m_transitions.push_back({});
+                m_outputs.push_back(0);
+            }
+            state = m_transitions[state][button];
+        }
+        m_outputs[state] |= uint64_t(1) << sequence->handle.slot;
+    }
+
+    // turn the trie into an automaton, by pointing every missing transition to where the longest suffix of the
+    // presses so far that is also a prefix of a sequence would be. Each state also recognizes every sequence that is
+    // recognized in the state of its longest suffix.
+    std::vector<uint16_t> fallback(m_transitions.size(), 0);
+    std::queue<uint16_t> queue;
+    for (uint16_t next : m_transitions[0])
+        if (next != 0) queue.push(next);
+    while (!queue.empty()) {
+        uint16_t state = queue.front();
+        queue.pop();
+        m_outputs[state] |= m_outputs[fallback[state]];
+        for (uint8_t button = 0; button < BUTTON_COUNT; button++) {
+            uint16_t& next = m_transitions[state][button];
+            if (next == 0) {
+                next = m_transitions[fallback[state]][button];
+            } else {
+                fallback[next] = m_transitions[fallback[state]][button];
+                queue.push(next);
+            }
+        }
+    }
+
+    m_state = 0;
+}
+
+void SequenceRecognizer::advance(uint8_t button, uint64_t now) {
+    if (m_listeners.isEmpty() || button >= BUTTON_COUNT) return;
+
+    std::lock_guard lock(m_mutex);
+    if (now - m_last_press_time > uint64_t(m_timeout) * 1000) m_state = 0;
+    m_last_press_time = now;
+    m_state = m_transitions[m_state][button];
+    const uint64_t recognized = m_outputs[m_state];
+    if (recognized == 0) return;
+    m_state = 0;
+    m_listeners.fireSlots(recognized);
+}
+} // namespace gamepad::_impl